@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace lily::crypto
+{
+    /**
+     * @brief The family of algorithms measured by a bench.
+     */
+    enum class BenchKind : uint8_t
+    {
+        // Key generation, encapsulation and decapsulation
+        LILY_BENCH_KEM,
+
+        // Key generation, signature and verification
+        LILY_BENCH_SIG
+    };
+
+    /**
+     * @brief The configuration of `bench-kem` and `bench-sig`.
+     */
+    struct BenchOptions
+    {
+        BenchKind kind {BenchKind::LILY_BENCH_KEM};
+
+        // The algorithms measured, `all` stands for every one of `SUPPORTED_PQC_GROUPS_LIST` for the KEMs, or of the
+        // PQC algorithms of `SUPPORTED_SIGALGS_LIST` for the signatures
+        std::vector<std::string> algorithms {};
+
+        // The numbers of threads running the primitives concurrently. One thread is always measured first, as the
+        // reference of the scaling efficiency.
+        std::vector<uint32_t> threads {1};
+
+        // The time measured for each algorithm and number of threads, in seconds
+        uint32_t durationSeconds {5};
+
+        // The JSON file of the results, named after the start time by default
+        std::filesystem::path outputPath {};
+    };
+} // namespace lily::crypto
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <lily/crypto/BenchOptions.h>
+#include <lily/log/LatencyHistogram.h>
+
+namespace lily::crypto
+{
+    /**
+     * @brief Measures the throughput of the KEM or signature primitives, without any TLS connection.
+     *
+     * Each thread runs full cycles of the three primitives of the algorithm (key generation, then encapsulation and
+     * decapsulation, or signature and verification) through the EVP API of OpenSSL, fetched from the OQS provider
+     * loaded by `loadOQSProvider`. Each primitive is timed in ns into a histogram of its thread, merged once the run
+     * is over, so the threads never share a cache line while measured. The runs are saved as one JSON table with
+     * their ops/s, their ns/op percentiles and their scaling efficiency against one thread.
+     */
+    class PrimitiveBench
+    {
+    private:
+        static constexpr std::size_t OPERATION_COUNT {3};
+
+        // The durations of the three primitives of a cycle, in ns
+        using Durations = std::array<log::LatencyHistogram, OPERATION_COUNT>;
+
+        struct Run
+        {
+            std::string algorithm;
+            uint32_t threads;
+            double seconds {};
+
+            // Whether every cycle of the run succeeded
+            bool measured {};
+
+            std::unique_ptr<Durations> durations {std::make_unique<Durations>()};
+        };
+
+        BenchOptions options;
+
+        // Run cycles on the calling thread until the deadline, false as soon as a primitive fails
+        static bool runCycles(BenchKind kind, std::string const& algorithm,
+                              std::chrono::steady_clock::time_point deadline, Durations& durations);
+
+        // Measure the algorithm on the given number of threads
+        Run measure(std::string const& algorithm, uint32_t threads) const;
+
+        // The name of each primitive of a cycle
+        std::array<std::string_view, OPERATION_COUNT> getOperationNames() const;
+
+        // Save the runs as the JSON table
+        void writeTable(std::vector<Run> const& runs) const;
+
+    public:
+        /**
+         * @brief Constructs a new `PrimitiveBench` instance.
+         *
+         * @param options The algorithms, the numbers of threads and the time measured on each run.
+         */
+        explicit PrimitiveBench(BenchOptions const& options);
+
+        /**
+         * @brief Measures every algorithm on every number of threads in turn, then saves the table.
+         */
+        void run();
+    };
+} // namespace lily::crypto
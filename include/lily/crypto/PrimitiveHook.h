@@ -0,0 +1,17 @@
+#pragma once
+
+namespace lily::crypto
+{
+    /**
+     * @brief Log the duration of the liboqs primitives to the `PrimitiveLog`.
+     *
+     * liboqs is patched by `external/liboqs-measuretime.patch` to time each successful `OQS_KEM_keypair`,
+     * `OQS_KEM_encaps`, `OQS_KEM_decaps`, `OQS_SIG_sign` and `OQS_SIG_verify` in ns and hand it to a hook, on the
+     * thread running the primitive. Without the hook, the primitives aren't timed. Must be called before the threads
+     * using the primitives are started, and after the `log::PrimitiveLog` settings, as it creates the log.
+     *
+     * Each record carries the id of the current `log::ConnectionContext` of the thread, whose handshake totals the
+     * primitive is also added to.
+     */
+    void installPrimitiveHook();
+} // namespace lily::crypto
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace lily::log
+{
+    /**
+     * @brief The time spent by one handshake in the primitives run by liboqs, in ns.
+     */
+    struct PrimitiveTimes
+    {
+        // The key generation, encapsulation and decapsulation
+        uint64_t kemNs {};
+
+        // The signature and its verification
+        uint64_t signatureNs {};
+    };
+
+    /**
+     * @brief The connection whose handshake OpenSSL is advancing on the calling thread.
+     *
+     * The primitives run by liboqs are added to the current context of their thread, and their records carry its id,
+     * so they can be matched with the rows of the connection which triggered them. A context is only current while
+     * OpenSSL processes its handshake, see `net::ConnectionTrace`.
+     */
+    struct ConnectionContext
+    {
+        // Unique within the process, logged with the rows of the connection and with its primitives. Only drawn by the
+        // `net::ConnectionTrace` of the connection, so the ids are consecutive, 0 until then.
+        uint64_t id {};
+        PrimitiveTimes primitives {};
+
+        // The context of the calling thread, or null outside of a handshake
+        static inline thread_local ConnectionContext* current {};
+
+        static uint64_t makeId()
+        {
+            static std::atomic_uint64_t nextId {1};
+            return nextId.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+} // namespace lily::log
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+namespace lily::log
+{
+    /**
+     * @brief The time spent in each phase of a TLS 1.3 handshake, as seen by one side of the connection.
+     *
+     * Each phase ends when its message is sent or received and starts at the previous message seen, or at the start
+     * of the handshake, so the phases add up to the time spent until the client Finished. A message missing from the
+     * handshake, like the certificate of a resumed one, has a zero phase.
+     */
+    struct HandshakePhases
+    {
+        int64_t clientHelloUs;
+        int64_t serverHelloUs;
+        int64_t encryptedExtensionsUs;
+        int64_t certificateUs;
+        int64_t certificateVerifyUs;
+        int64_t serverFinishedUs;
+        int64_t clientFinishedUs;
+    };
+} // namespace lily::log
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+namespace lily::log
+{
+    /**
+     * @brief The TLS records of a handshake, as put on the wire by one side of the connection.
+     *
+     * The bytes include the 5-byte header of each record, so they are the TCP payload of the handshake.
+     */
+    struct HandshakeTraffic
+    {
+        uint64_t bytesSent;
+        uint64_t bytesReceived;
+        uint32_t recordsSent;
+        uint32_t recordsReceived;
+    };
+} // namespace lily::log
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <span>
+
+#include <lily/log/HandshakeTraffic.h>
+
+namespace lily::log
+{
+    /**
+     * @brief A lock-free latency histogram in the style of HdrHistogram.
+     *
+     * The values below 64 have their own bucket, the larger ones fall into 32 linear buckets per power of two, so
+     * every recorded value is known within about 3% whatever its magnitude. Recording is a relaxed atomic increment,
+     * so any thread can record while another one reads or merges the histogram.
+     */
+    class LatencyHistogram
+    {
+    private:
+        static constexpr uint32_t SUB_BUCKET_HALF_COUNT {32};
+        static constexpr uint32_t SUB_BUCKET_COUNT {SUB_BUCKET_HALF_COUNT * 2};
+
+        // Up to 2^41 - 1 µs, about 25 days, the larger values are clamped to the last bucket
+        static constexpr uint32_t MAX_EXPONENT {35};
+        static constexpr uint32_t BUCKET_COUNT {SUB_BUCKET_COUNT + MAX_EXPONENT * SUB_BUCKET_HALF_COUNT};
+
+        std::array<std::atomic_uint64_t, BUCKET_COUNT> buckets {};
+        std::atomic_uint64_t totalCount {};
+        std::atomic_uint64_t totalSum {};
+        std::atomic_uint64_t maxValue {};
+
+        static uint32_t getIndex(uint64_t value);
+
+        // The highest value counted in the bucket
+        static uint64_t getHighestEquivalent(uint32_t index);
+
+    public:
+        // The size of the raw state sent to another process: the bucket counts, followed by the sum and the max
+        static constexpr std::size_t SERIALIZED_SIZE {BUCKET_COUNT + 2};
+
+        LatencyHistogram() = default;
+        LatencyHistogram(LatencyHistogram const&)            = delete;
+        LatencyHistogram& operator=(LatencyHistogram const&) = delete;
+
+        // Count one value, the negative ones are counted as zero
+        void record(int64_t value);
+
+        // Add every count of `other` to this histogram
+        void add(LatencyHistogram const& other);
+
+        // Move every count of this histogram to `target`. A value recorded meanwhile is either moved or kept for the
+        // next call, never lost.
+        void drainInto(LatencyHistogram& target);
+
+        // Forget every recorded value
+        void reset();
+
+        // Copy the raw state to `target`, or add the raw state of another histogram to this one
+        void serialize(std::span<uint64_t, SERIALIZED_SIZE> target) const;
+        void addSerialized(std::span<uint64_t const, SERIALIZED_SIZE> source);
+
+        uint64_t getCount() const
+        {
+            return this->totalCount.load(std::memory_order_relaxed);
+        }
+        uint64_t getMax() const
+        {
+            return this->maxValue.load(std::memory_order_relaxed);
+        }
+        uint64_t getSum() const
+        {
+            return this->totalSum.load(std::memory_order_relaxed);
+        }
+        double getMean() const;
+
+        // The number of values counted in the buckets whose values are all at most `value`, so a bucket straddling
+        // `value` isn't included
+        uint64_t getCountAtOrBelow(uint64_t value) const;
+
+        // The value below which the given percentage (0 to 100) of the recorded values fall, zero if empty
+        uint64_t getPercentile(double percentile) const;
+    };
+
+    /**
+     * @brief The handshakes negotiated with one key exchange group, summed.
+     */
+    struct GroupTotals
+    {
+        enum Total
+        {
+            LILY_GROUP_HANDSHAKES,
+            LILY_GROUP_HANDSHAKE_US,
+            LILY_GROUP_BYTES_SENT,
+            LILY_GROUP_BYTES_RECEIVED,
+            LILY_GROUP_RECORDS_SENT,
+            LILY_GROUP_RECORDS_RECEIVED,
+            LILY_GROUP_TOTAL_COUNT
+        };
+
+        std::array<std::atomic_uint64_t, LILY_GROUP_TOTAL_COUNT> totals {};
+
+        // The total per handshake, zero without any handshake
+        double getMean(Total total) const;
+    };
+
+    /**
+     * @brief The latency histograms of the client requests, in µs, and the bytes their connections put on the wire.
+     */
+    struct RequestHistograms
+    {
+        // Only recorded for the first request of each connection
+        LatencyHistogram handshake {};
+        LatencyHistogram write {};
+        LatencyHistogram read {};
+
+        // From the scheduled start of the request to its response
+        LatencyHistogram total {};
+
+        // The bytes of the TLS records sent and received by the handshakes, headers included, one per `handshake`
+        std::atomic_uint64_t handshakeBytesSent {};
+        std::atomic_uint64_t handshakeBytesReceived {};
+
+        // The handshakes of each group offered by the client, in the order of `ClientOptions::tlsGroup`. The groups
+        // offered after the first `MAX_GROUP_COUNT` ones aren't summed.
+        static constexpr std::size_t MAX_GROUP_COUNT {8};
+        std::array<GroupTotals, MAX_GROUP_COUNT> groups {};
+
+        // The size of the raw state of the four histograms, followed by the handshake bytes and the group totals
+        static constexpr std::size_t SERIALIZED_SIZE {LatencyHistogram::SERIALIZED_SIZE * 4 + 2 +
+                                                      MAX_GROUP_COUNT * GroupTotals::LILY_GROUP_TOTAL_COUNT};
+
+        // Count the bytes sent and received by one handshake
+        void recordHandshakeBytes(uint64_t sent, uint64_t received);
+
+        // Count one handshake negotiated with the group at `group` in the offered groups
+        void recordGroup(std::size_t group, int64_t handshakeUs, HandshakeTraffic const& traffic);
+
+        void add(RequestHistograms const& other);
+        void drainInto(RequestHistograms& target);
+        void reset();
+        void serialize(std::span<uint64_t, SERIALIZED_SIZE> target) const;
+        void addSerialized(std::span<uint64_t const, SERIALIZED_SIZE> source);
+    };
+} // namespace lily::log
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+#include <lily/core/ErrorCode.h>
+
+namespace lily::log
+{
+    /**
+     * @brief Converts a binary log to the CSV layout of the same log written as text.
+     *
+     * Only the fields described by the header of the binary log are read, so any version of the record is exported.
+     *
+     * @param input The binary log, `*.bin`.
+     * @param output The CSV file to create.
+     * @return The number of exported records.
+     */
+    core::Expect<uint64_t> exportCsv(std::filesystem::path const& input, std::filesystem::path const& output);
+} // namespace lily::log
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include <lily/log/LogFormat.h>
+
+namespace lily::log
+{
+    /**
+     * @brief The file a `RecordWriter` appends its batches to.
+     */
+    class LogFile
+    {
+    public:
+        virtual ~LogFile() = default;
+
+        // Append the formatted or packed records
+        virtual void append(std::string_view batch) = 0;
+
+        // Make the records appended so far visible to the readers of the file
+        virtual void flush() = 0;
+
+        /**
+         * @brief Creates the log file for the given format, with the header of its fields. Exits if it can't.
+         *
+         * @param baseName The file name without its extension, `.csv` or `.bin`.
+         * @param fields The fields of the records, in the order of the CSV columns.
+         */
+        static std::unique_ptr<LogFile> create(std::string const& baseName, LogFormat format,
+                                               std::span<LogField const> fields);
+    };
+
+    /**
+     * @brief A CSV log, written through a file stream.
+     */
+    class TextLogFile final : public LogFile
+    {
+    private:
+        std::ofstream stream;
+
+    public:
+        TextLogFile(std::ofstream&& stream);
+
+        void append(std::string_view batch) override;
+        void flush() override;
+    };
+
+    /**
+     * @brief A binary log, written through a memory mapping of the file.
+     *
+     * The file is extended and mapped one chunk at a time ahead of the writes, so appending a batch is a copy into
+     * the page cache, without any write syscall. The record count of the header is updated on each flush, and the
+     * unused end of the last chunk is truncated once the log is closed.
+     */
+    class MappedLogFile final : public LogFile
+    {
+    private:
+        static constexpr std::size_t CHUNK_SIZE {64 << 20};
+
+        int fd;
+        uint32_t recordSize;
+
+        // The size of the header and of the fields, then of the records appended so far
+        std::size_t headerSize;
+        std::size_t dataSize {};
+
+        // The mapped chunk of the file, and its offset
+        char* chunk {};
+        std::size_t chunkOffset {};
+
+        // Set once the file can't be extended, the later records are dropped
+        bool failed {};
+
+        // Map the chunk holding the given offset of the file, extending the file first
+        bool mapChunk(std::size_t offset);
+
+    public:
+        MappedLogFile(int fd, uint32_t recordSize, std::size_t headerSize);
+        MappedLogFile(MappedLogFile const&)            = delete;
+        MappedLogFile& operator=(MappedLogFile const&) = delete;
+        ~MappedLogFile() override;
+
+        void append(std::string_view batch) override;
+        void flush() override;
+    };
+} // namespace lily::log
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace lily::log
+{
+    /**
+     * @brief How the records of a log are stored.
+     */
+    enum class LogFormat : uint8_t
+    {
+        LILY_LOG_FORMAT_CSV,   // One `;` separated line per record
+        LILY_LOG_FORMAT_BINARY // Fixed-width records after a header describing the fields, see `BinaryLogHeader`
+    };
+
+    /**
+     * @brief The type of one field of a binary record.
+     */
+    enum class LogFieldType : uint8_t
+    {
+        LILY_FIELD_INT64,
+        LILY_FIELD_UINT64,
+        LILY_FIELD_UINT32,
+        LILY_FIELD_BOOL,
+        LILY_FIELD_NAME // A `LogName`
+    };
+
+    // A name stored in a record, padded with zeros so the records keep a fixed size. A longer name is truncated.
+    using LogName = std::array<char, 32>;
+
+    inline LogName makeLogName(std::string_view name)
+    {
+        LogName logName {};
+        std::memcpy(logName.data(), name.data(), std::min(name.size(), logName.size()));
+        return logName;
+    }
+
+    inline std::string_view getLogName(LogName const& logName)
+    {
+        return {logName.data(), strnlen(logName.data(), logName.size())};
+    }
+
+    /**
+     * @brief One field of a record, in the order of the CSV columns.
+     */
+    struct LogField
+    {
+        // The name of the CSV column
+        std::string_view name;
+        LogFieldType type;
+
+        // Where the field lies in the in-memory record
+        std::size_t offset;
+    };
+
+    /**
+     * @brief The start of a binary log, followed by one `BinaryLogField` per field, then by the packed records.
+     *
+     * Every integer is little-endian. The records are packed in the order of the fields, without padding, and the
+     * file may be longer than `recordCount` records, since it is extended ahead of the writes.
+     */
+    struct BinaryLogHeader
+    {
+        static constexpr char MAGIC[8] {"LILYLOG"};
+
+        // Version 2 added `LogFieldType::LILY_FIELD_NAME`
+        static constexpr uint32_t VERSION {2};
+
+        char magic[8] {};
+        uint32_t version {};
+        uint32_t fieldCount {};
+        uint32_t recordSize {};
+        uint32_t reserved {};
+        uint64_t recordCount {};
+    };
+
+    struct BinaryLogField
+    {
+        char name[32] {};
+        LogFieldType type {};
+        uint8_t reserved[3] {};
+
+        // Where the field lies in the packed record
+        uint32_t offset {};
+    };
+
+    // The size of a field of the given type in a packed record
+    constexpr uint32_t getFieldSize(LogFieldType type)
+    {
+        switch (type)
+        {
+        case LogFieldType::LILY_FIELD_UINT32:
+            return 4;
+        case LogFieldType::LILY_FIELD_BOOL:
+            return 1;
+        case LogFieldType::LILY_FIELD_NAME:
+            return sizeof(LogName);
+        default:
+            return 8;
+        }
+    }
+
+    // The size of a packed record
+    constexpr uint32_t getRecordSize(std::span<LogField const> fields)
+    {
+        uint32_t size {};
+        for (auto const& field: fields)
+            size += getFieldSize(field.type);
+        return size;
+    }
+
+    // Append the packed fields of `record` to the batch
+    template<class Record>
+    void packRecord(Record const& record, std::span<LogField const> fields, std::string& batch)
+    {
+        auto bytes {reinterpret_cast<char const*>(&record)};
+        for (auto const& field: fields)
+            batch.append(bytes + field.offset, getFieldSize(field.type));
+    }
+} // namespace lily::log
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+namespace lily::log
+{
+    /**
+     * @brief What a thread logging a record does when its ring buffer is full.
+     */
+    enum class LogOverflow : uint8_t
+    {
+        LILY_LOG_OVERFLOW_BLOCK, // Wait until the writer thread frees a slot, so no record is lost
+        LILY_LOG_OVERFLOW_DROP   // Drop the record and count it, so the measured thread never waits for the disk
+    };
+} // namespace lily::log
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <lily/log/LogFormat.h>
+
+namespace lily::log
+{
+    /**
+     * @brief What the handshake of a connection agreed on, empty when unknown.
+     */
+    struct NegotiatedParameters
+    {
+        // The key exchange group
+        LogName group;
+
+        // The signature algorithm of the server, empty for a resumed handshake
+        LogName sigalg;
+
+        LogName cipher;
+    };
+} // namespace lily::log
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <lily/log/LatencyHistogram.h>
+#include <lily/log/LogFormat.h>
+#include <lily/log/LogOverflow.h>
+#include <lily/log/RecordWriter.h>
+
+namespace lily::log
+{
+    /**
+     * @brief The KEM and signature primitives timed by liboqs, in the order of its `OQS_MEASURE_OPERATION`.
+     */
+    enum class PrimitiveOperation : uint8_t
+    {
+        LILY_PRIMITIVE_KEYGEN,
+        LILY_PRIMITIVE_ENCAPS,
+        LILY_PRIMITIVE_DECAPS,
+        LILY_PRIMITIVE_SIGN,
+        LILY_PRIMITIVE_VERIFY
+    };
+
+    /**
+     * @brief A class to record and log the duration of the KEM and signature primitives run by liboqs, in ns.
+     *
+     * The samples are buffered per thread and written by a background thread, see `RecordWriter`. The writer thread
+     * also sums them per operation and algorithm, so the thread running the primitive never locks nor formats.
+     */
+    class PrimitiveLog
+    {
+    private:
+        struct Record
+        {
+            uint64_t connectionId;
+            LogName operation;
+            LogName algorithm;
+            uint64_t durationNs;
+        };
+
+        // The fields of the records, in the order of the CSV columns
+        static std::array<LogField, 4> const FIELDS;
+
+        // The durations of each operation and algorithm, added to by the writer thread only
+        std::mutex summaryMtx;
+        std::map<std::pair<std::string, std::string>, std::unique_ptr<LatencyHistogram>> summary {};
+
+        // Declared last, so the summary is built before the writer thread starts
+        RecordWriter<Record> writer;
+
+        PrimitiveLog();
+
+        PrimitiveLog(PrimitiveLog const&)            = delete;
+        PrimitiveLog(PrimitiveLog&&)                 = delete;
+        PrimitiveLog& operator=(PrimitiveLog const&) = delete;
+        PrimitiveLog& operator=(PrimitiveLog&&)      = delete;
+
+        static void formatCsv(Record const& record, std::string& batch);
+        static void formatBinary(Record const& record, std::string& batch);
+
+        // Add the sample to the summary, the observer of the writer, so called by the writer thread only
+        void summarize(Record const& record);
+
+    public:
+        static PrimitiveLog& getInstance();
+
+        // Name the file `<prefix>_primitives`, so each run and process gets its own file. Must be called before the
+        // first `getInstance`.
+        static void setFilePrefix(std::string const& prefix);
+
+        // Store the records as CSV lines, the default, or as binary records. Must be called before the first
+        // `getInstance`.
+        static void setFormat(LogFormat format);
+
+        // What a thread does when its buffer is full, blocking by default
+        static void setOverflow(LogOverflow overflow);
+
+        static std::string_view getOperationName(PrimitiveOperation operation);
+
+        // Called on the thread which ran the primitive. The connection id is 0 outside of a handshake.
+        void write(uint64_t connectionId, PrimitiveOperation operation, char const* algorithm, uint64_t durationNs);
+
+        // Print the count and percentiles of each operation and algorithm logged so far
+        void report();
+    };
+} // namespace lily::log
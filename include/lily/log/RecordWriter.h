@@ -0,0 +1,278 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <lily/log/LogFile.h>
+#include <lily/log/LogOverflow.h>
+
+namespace lily::log
+{
+    /**
+     * @brief The part of a `RecordWriter` flushed on shutdown, whatever its record type.
+     */
+    class RecordSink
+    {
+    protected:
+        // The name of the log in the warnings
+        std::string name;
+
+        RecordSink(std::string name);
+        ~RecordSink() = default;
+
+        // Add this writer to the ones flushed on shutdown once fully built, and remove it before its destruction
+        void registerSink();
+        void unregisterSink();
+
+        // Warn about the records dropped by the `LogOverflow::LILY_LOG_OVERFLOW_DROP` policy, if any
+        void warnDropped(uint64_t droppedCount) const;
+
+    public:
+        RecordSink(RecordSink const&)            = delete;
+        RecordSink& operator=(RecordSink const&) = delete;
+
+        // Write every record logged so far to the file
+        virtual void flush() = 0;
+    };
+
+    // Write the records logged so far by every writer to their files
+    void flushRecordWriters();
+
+    // Flush every writer, then exit, on SIGINT or SIGTERM. Both signals are blocked in the calling thread and in the
+    // threads it starts afterward, so it must be called before any other thread is started, and again in a forked
+    // process.
+    void watchShutdownSignals();
+
+    /**
+     * @brief A single-producer single-consumer ring of fixed-size records.
+     *
+     * Only the thread owning the ring pushes, only the writer thread drains, so neither side ever locks. A ring is
+     * handed to another thread once its owner exited, its records still pending are drained in order.
+     */
+    template<class Record>
+    class RecordRing
+    {
+    private:
+        // About 64 KiB of records, between 64 and 1024 of them
+        static constexpr std::size_t CAPACITY {
+            std::clamp<std::size_t>(std::bit_ceil((std::size_t {1} << 16) / sizeof(Record)), 64, 1024)};
+
+        // Left uninitialized, each slot is written before being drained
+        std::array<Record, CAPACITY> records;
+
+        // The next slot pushed by the producer and the next one drained by the consumer, on their own cache lines
+        alignas(64) std::atomic_size_t head {};
+        alignas(64) std::atomic_size_t tail {};
+
+    public:
+        RecordRing() {}
+
+        // Copy the record into the ring. Returns false if the ring is full.
+        bool push(Record const& record)
+        {
+            auto head {this->head.load(std::memory_order_relaxed)};
+            if (head - this->tail.load(std::memory_order_acquire) == CAPACITY)
+                return false;
+            this->records[head % CAPACITY] = record;
+            this->head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Hand every record pushed so far to `consumer`, then free their slots. Returns the number of records.
+        template<class Consumer>
+        std::size_t drain(Consumer&& consumer)
+        {
+            auto tail {this->tail.load(std::memory_order_relaxed)};
+            auto head {this->head.load(std::memory_order_acquire)};
+            for (auto i {tail}; i != head; ++i)
+                consumer(this->records[i % CAPACITY]);
+            this->tail.store(head, std::memory_order_release);
+            return head - tail;
+        }
+    };
+
+    /**
+     * @brief Logs fixed-size records without formatting, locking or writing to the file on the logging thread.
+     *
+     * Each logging thread pushes its records into its own `RecordRing`. A background thread drains every ring,
+     * formats or packs the records and appends them to the `LogFile` in large batches. The rings of a record type
+     * are kept per thread, so there must only be one writer per record type, which the singleton logs guarantee.
+     */
+    template<class Record>
+    class RecordWriter final : public RecordSink
+    {
+    public:
+        // Append one record to the batch, as a CSV line or packed
+        using Formatter = void (*)(Record const& record, std::string& batch);
+
+        // Sees each record before it is formatted, on the writer thread
+        using Observer = std::function<void(Record const& record)>;
+
+    private:
+        // The batch is written once it reaches this size, or once every ring is drained
+        static constexpr std::size_t BATCH_SIZE {1 << 20};
+
+        // The time the writer thread sleeps once every ring is empty
+        static constexpr std::chrono::milliseconds DRAIN_INTERVAL {10};
+
+        // The rings of the threads which exited, reused by the next threads. Shared with the threads, which may exit
+        // after the writer.
+        struct FreeRings
+        {
+            std::mutex mtx;
+            std::vector<std::shared_ptr<RecordRing<Record>>> rings {};
+        };
+
+        // Returns the ring of a thread to the free rings when the thread exits
+        struct RingHolder
+        {
+            std::shared_ptr<RecordRing<Record>> ring {};
+            std::shared_ptr<FreeRings> freeRings {};
+
+            ~RingHolder()
+            {
+                if (!this->ring)
+                    return;
+                std::lock_guard lock {this->freeRings->mtx};
+                this->freeRings->rings.push_back(std::move(this->ring));
+            }
+        };
+
+        std::unique_ptr<LogFile> file;
+        Formatter format;
+        Observer observe;
+
+        // Every ring ever used, so at most one per thread logging at the same time, only locked when a thread logs its
+        // first record. A free ring may still hold records of its last thread, so it is drained like the others.
+        std::mutex ringsMtx;
+        std::vector<std::shared_ptr<RecordRing<Record>>> rings {};
+        std::shared_ptr<FreeRings> freeRings {std::make_shared<FreeRings>()};
+
+        // Serializes the drains of the writer thread and of a flush
+        std::mutex drainMtx;
+        std::string batch {};
+
+        std::atomic_uint64_t droppedCount {};
+
+        // Started once every other member is built
+        std::jthread writer;
+
+        RecordRing<Record>& getRing()
+        {
+            thread_local RingHolder holder {};
+            if (holder.ring)
+                return *holder.ring;
+
+            // Take over the ring of a thread which exited, the lock orders its last pushes before the next ones
+            holder.freeRings = this->freeRings;
+            {
+                std::lock_guard lock {this->freeRings->mtx};
+                if (!this->freeRings->rings.empty())
+                {
+                    holder.ring = this->freeRings->rings.back();
+                    this->freeRings->rings.pop_back();
+                    return *holder.ring;
+                }
+            }
+            std::lock_guard lock {this->ringsMtx};
+            holder.ring = this->rings.emplace_back(std::make_shared<RecordRing<Record>>());
+            return *holder.ring;
+        }
+
+        void writeBatch()
+        {
+            if (this->batch.empty())
+                return;
+            this->file->append(this->batch);
+            this->file->flush();
+            this->batch.clear();
+        }
+
+        // Write the records of every ring. Returns the number of records written.
+        std::size_t drain()
+        {
+            std::lock_guard drainLock {this->drainMtx};
+            std::vector<std::shared_ptr<RecordRing<Record>>> rings {};
+            {
+                std::lock_guard lock {this->ringsMtx};
+                rings = this->rings;
+            }
+
+            std::size_t count {};
+            for (auto& ring: rings)
+                count += ring->drain(
+                    [this](Record const& record)
+                    {
+                        if (this->observe)
+                            this->observe(record);
+                        this->format(record, this->batch);
+                        if (this->batch.size() >= BATCH_SIZE)
+                            this->writeBatch();
+                    });
+            this->writeBatch();
+            return count;
+        }
+
+    public:
+        /**
+         * @brief Starts the writer thread of `file`.
+         *
+         * @param file The open file, its header already written.
+         * @param format Formats one record, called by the writer thread only.
+         * @param name The name of the log in the warnings.
+         * @param observe Sees each record before it is formatted, called by the writer thread only. Optional.
+         */
+        RecordWriter(std::unique_ptr<LogFile> file, Formatter format, std::string name, Observer observe = {}):
+            RecordSink(std::move(name)), file(std::move(file)), format(format), observe(std::move(observe))
+        {
+            this->batch.reserve(BATCH_SIZE);
+            this->writer = std::jthread {[this](std::stop_token stopToken)
+                                         {
+                                             while (!stopToken.stop_requested())
+                                                 if (this->drain() == 0)
+                                                     std::this_thread::sleep_for(DRAIN_INTERVAL);
+                                         }};
+            this->registerSink();
+        }
+
+        ~RecordWriter()
+        {
+            this->unregisterSink();
+            this->writer.request_stop();
+            this->writer.join();
+            this->flush();
+        }
+
+        /**
+         * @brief Pushes the record into the ring of the calling thread, applying `overflow` if the ring is full.
+         */
+        void write(Record const& record, LogOverflow overflow)
+        {
+            auto& ring {this->getRing()};
+            while (!ring.push(record))
+            {
+                if (overflow == LogOverflow::LILY_LOG_OVERFLOW_DROP)
+                {
+                    this->droppedCount.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                std::this_thread::yield();
+            }
+        }
+
+        void flush() override
+        {
+            this->drain();
+            this->warnDropped(this->droppedCount.load(std::memory_order_relaxed));
+        }
+    };
+} // namespace lily::log
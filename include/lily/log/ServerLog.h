@@ -1,18 +1,48 @@
 #pragma once
 
-#include <fstream>
-#include <mutex>
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include <lily/log/ConnectionContext.h>
+#include <lily/log/HandshakePhases.h>
+#include <lily/log/HandshakeTraffic.h>
+#include <lily/log/LogFormat.h>
+#include <lily/log/LogOverflow.h>
+#include <lily/log/NegotiatedParameters.h>
+#include <lily/log/RecordWriter.h>
 
 namespace lily::log
 {
     /**
      * @brief A class to record and log the duration of SSL/TLS handshakes and SSL/TLS read.
+     *
+     * The records are buffered per thread and written by a background thread, see `RecordWriter`.
      */
     class ServerLog
     {
     private:
-        std::ofstream stream;
-        std::mutex mtx;
+        struct Record
+        {
+            int64_t hsDurationUs;
+            HandshakePhases phases;
+            HandshakeTraffic traffic;
+            uint64_t recvSize;
+            int64_t recvDurationUs;
+            uint64_t writeSize;
+            int64_t writeDurationUs;
+            bool resumed;
+            bool ktlsSend;
+            bool ktlsRecv;
+            NegotiatedParameters parameters;
+            uint64_t connectionId;
+            PrimitiveTimes primitives;
+        };
+
+        // The fields of the records, in the order of the CSV columns
+        static std::array<LogField, 25> const FIELDS;
+
+        RecordWriter<Record> writer;
 
         ServerLog();
 
@@ -21,10 +51,26 @@ namespace lily::log
         ServerLog& operator=(ServerLog const&) = delete;
         ServerLog& operator=(ServerLog&&)      = delete;
 
+        static void formatCsv(Record const& record, std::string& batch);
+        static void formatBinary(Record const& record, std::string& batch);
+
     public:
         static ServerLog& getInstance();
 
+        // The file name without its extension, also used by the other logs of the run
+        static std::string getFilePrefix();
+
+        // Store the records as CSV lines, the default, or as binary records. Must be called before the first
+        // `getInstance`.
+        static void setFormat(LogFormat format);
+
+        // What a thread does when its buffer is full, blocking by default
+        static void setOverflow(LogOverflow overflow);
+
         // 
-        void write(int64_t hsDurationUs, uint64_t recvSize, int64_t recvDurationUs, uint64_t writeSize, int64_t writeDurationUs);
+        void write(int64_t hsDurationUs, HandshakePhases const& phases, HandshakeTraffic const& traffic,
+                   uint64_t recvSize, int64_t recvDurationUs, uint64_t writeSize, int64_t writeDurationUs,
+                   bool resumed, bool ktlsSend, bool ktlsRecv, NegotiatedParameters const& parameters,
+                   uint64_t connectionId, PrimitiveTimes const& primitives);
     };
 } // namespace lily::log
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+#include <string_view>
+
+namespace lily::net
+{
+    /**
+     * @brief Decides whether an accept loop goes on after a failed `async_accept`.
+     *
+     * The loop ends once the accept is cancelled or the acceptor closed. Any other error, such as running out of file
+     * descriptors under load, is logged then waited out, so the loop never spins on a persistent error.
+     *
+     * @param acceptor The acceptor of the failed accept.
+     * @param ec The error of the accept.
+     * @param name The name of the acceptor in the log, e.g. `server shard 2`.
+     * @return Whether to accept again.
+     */
+    boost::asio::awaitable<bool> retryAccept(boost::asio::ip::tcp::acceptor& acceptor,
+                                             boost::beast::error_code const& ec, std::string_view name);
+} // namespace lily::net
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast.hpp>
+
+#include <lily/log/ConnectionContext.h>
+#include <lily/log/HandshakePhases.h>
+#include <lily/log/HandshakeTraffic.h>
+#include <lily/log/NegotiatedParameters.h>
+#include <lily/net/HandshakeAdmission.h>
+#include <lily/net/SessionPool.h>
+
+namespace lily::net
+{
+    /**
+     * @brief The asynchronous counterpart of `ServerSession`.
+     *
+     * Every operation is a coroutine running on the executor of the accepted socket, so a small pool of worker
+     * threads can serve many connections at once. The logged fields are the same as `ServerSession`.
+     */
+    class AsyncServerSession
+    {
+    private:
+        // Declared before the stream, so the pooled object is handed back after the stream released it
+        PooledSSL pooled;
+
+        boost::asio::ssl::stream<boost::beast::tcp_stream> stream;
+        boost::beast::flat_buffer buffer;
+
+        // Optional counter of the successful handshakes, owned by the caller
+        std::atomic_uint64_t* handshakeCount;
+
+        // The handshake admission, or null if the handshakes are unlimited
+        HandshakeAdmission* admission;
+
+        // Whether the handshake slot was already acquired before accepting the connection
+        bool admitted;
+
+        // The body window of the streaming echo, empty when the whole body is buffered
+        std::vector<char> window;
+
+        // Echo one request by forwarding its body chunks through `window` as they are decrypted
+        boost::asio::awaitable<bool> echoStreaming(int64_t handshakeDuration, log::HandshakePhases const& phases,
+                                                   log::HandshakeTraffic const& traffic,
+                                                   log::NegotiatedParameters const& parameters,
+                                                   log::ConnectionContext const& context,
+                                                   boost::beast::error_code& ec);
+
+    public:
+        AsyncServerSession(AsyncServerSession const&)            = delete;
+        AsyncServerSession& operator=(AsyncServerSession const&) = delete;
+
+        // Take ownership of the socket
+        AsyncServerSession(boost::asio::ip::tcp::socket&& socket, boost::asio::ssl::context& ctx,
+                           std::atomic_uint64_t* handshakeCount = nullptr, HandshakeAdmission* admission = nullptr,
+                           bool admitted = false, uint32_t streamWindow = 0):
+            pooled(SessionPool::getInstance().acquireSSL(ctx.native_handle())),
+            stream(SessionPool::makeStream(std::move(socket), ctx, pooled.get())),
+            buffer(SessionPool::getInstance().acquireBuffer()), handshakeCount(handshakeCount), admission(admission),
+            admitted(admitted), window(streamWindow)
+        {
+        }
+        ~AsyncServerSession()
+        {
+            SessionPool::getInstance().releaseBuffer(std::move(this->buffer));
+        }
+
+        // Start the asynchronous operation
+        boost::asio::awaitable<void> run();
+
+        // Close the communication
+        boost::asio::awaitable<void> close();
+    };
+} // namespace lily::net
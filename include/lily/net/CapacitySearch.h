@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+
+#include <lily/core/ErrorCode.h>
+#include <lily/net/CapacitySearchOptions.h>
+#include <lily/net/ClientOptions.h>
+#include <lily/net/ClientRunner.h>
+
+namespace lily::net
+{
+    /**
+     * @brief Finds the highest load the server sustains within a latency SLO and an error budget.
+     *
+     * Each step offers an open-loop rate for a warm-up and a measured window. The rate grows by a fixed step, or
+     * doubles until a step fails and is then bisected, and the knee is the last passing step: the maximum sustainable
+     * TPS for the `ClientOptions::tlsGroup` under test, with its latency.
+     */
+    class CapacitySearch
+    {
+    private:
+        CapacitySearchOptions options;
+        std::unique_ptr<ClientRunner> runner;
+
+        CapacitySearch(CapacitySearchOptions const& options, std::unique_ptr<ClientRunner> runner);
+
+        // Measure one step, print it and tell whether it stayed within the SLO and the error budget
+        bool measureStep(double rate, ClientRunner::Measurement& measurement);
+
+    public:
+        CapacitySearch(CapacitySearch&&)                 = default;
+        CapacitySearch& operator=(CapacitySearch&&)      = default;
+        CapacitySearch(CapacitySearch const&)            = delete;
+        CapacitySearch& operator=(CapacitySearch const&) = delete;
+
+        /**
+         * @brief Constructs a new `CapacitySearch` instance.
+         *
+         * @param clientOptions The server, the users and the engine configuration, `ClientOptions::rate` is ignored.
+         * @param options The steps and the SLO of the search.
+         */
+        static core::Expect<CapacitySearch> create(ClientOptions const& clientOptions,
+                                                   CapacitySearchOptions const& options);
+
+        /**
+         * @brief Runs the steps and returns the knee point, or nothing if even the lowest rate failed.
+         */
+        std::optional<ClientRunner::Measurement> run();
+    };
+} // namespace lily::net
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+namespace lily::net
+{
+    /**
+     * @brief The configuration of `capacity-search`, on top of the `ClientOptions` of the users.
+     */
+    struct CapacitySearchOptions
+    {
+        // The first offered rate, in connections per second
+        double startRate {100};
+
+        // The offered rate never goes beyond this one
+        double maxRate {100000};
+
+        // The rate added after each passing step. Zero doubles the rate instead, then bisects between the last
+        // passing and the first failing rates.
+        double stepRate {};
+
+        // The bisection stops once the failing rate is within this fraction of the passing one
+        double precision {0.05};
+
+        // A step fails once its p99 latency is above this one
+        double sloP99Ms {100};
+
+        // A step fails once this fraction of its requests and arrivals failed or were dropped
+        double maxErrorRate {0.01};
+
+        // The time given to the server to reach its steady state on each step, not measured, in seconds
+        uint32_t warmUpSeconds {5};
+
+        // The time measured on each step once warmed up, in seconds
+        uint32_t windowSeconds {10};
+    };
+} // namespace lily::net
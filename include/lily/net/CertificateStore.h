@@ -0,0 +1,67 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <string>
+#include <vector>
+
+#include <lily/core/ErrorCode.h>
+
+namespace lily::net
+{
+    /**
+     * @brief The key/certificate pairs the server chooses from on every handshake.
+     *
+     * Every pair of the directory is named after its files, `<name>.crt` holding the certificate followed by its
+     * chain, and `<name>.key` holding the private key. The certificate callback picks the pair whose name matches the
+     * SNI sent by the client, otherwise the first pair signing with an algorithm offered in the client
+     * `signature_algorithms`, so a single server covers every signature algorithm.
+     */
+    class CertificateStore
+    {
+    private:
+        static void freeChain(STACK_OF(X509) * chain);
+
+        struct Entry
+        {
+            std::string name;
+            std::unique_ptr<X509, decltype(&X509_free)> certificate {nullptr, X509_free};
+            std::unique_ptr<STACK_OF(X509), decltype(&freeChain)> chain {nullptr, freeChain};
+            std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> privateKey {nullptr, EVP_PKEY_free};
+        };
+
+        // Sorted by name, the first pair is the default one
+        std::vector<Entry> entries {};
+
+        CertificateStore() = default;
+
+        // Load the `<name>.crt` and `<name>.key` files of one pair
+        static core::Expect<Entry> loadEntry(std::filesystem::path const& certificatePath);
+
+        // Find the pair to present to the client
+        Entry const& select(SSL* ssl) const;
+
+        // The `SSL_CTX_set_cert_cb` callback, `arg` is the store
+        static int onCertificate(SSL* ssl, void* arg);
+
+    public:
+        CertificateStore(CertificateStore const&)            = delete;
+        CertificateStore& operator=(CertificateStore const&) = delete;
+
+        /**
+         * @brief Loads every key/certificate pair of the directory.
+         *
+         * @param directory The directory holding the `<name>.crt` and `<name>.key` files.
+         */
+        static core::Expect<std::unique_ptr<CertificateStore>> load(std::filesystem::path const& directory);
+
+        /**
+         * @brief Uses the default pair for `ctx` and installs the certificate callback choosing between the pairs.
+         *
+         * The store must outlive `ctx`.
+         */
+        core::Expect<void> attach(SSL_CTX* ctx) const;
+    };
+} // namespace lily::net
@@ -3,25 +3,44 @@
 #include <boost/asio.hpp>
 #include <boost/asio/ssl.hpp>
 #include <boost/beast.hpp>
+#include <stop_token>
 
 #include <lily/core/ErrorCode.h>
+#include <lily/net/ClientOptions.h>
+#include <lily/net/ClientSetup.h>
+#include <lily/net/VirtualUser.h>
 
 namespace lily::net
 {
     class ClientConnection
     {
     private:
-        std::unique_ptr<boost::beast::net::io_context> ioc;
-        boost::asio::ssl::context ctx;
+        std::shared_ptr<ClientSetup> setup;
 
-        ClientConnection();
+        ClientConnection(std::shared_ptr<ClientSetup> setup);
         ClientConnection(ClientConnection const&)            = delete;
         ClientConnection& operator=(ClientConnection const&) = delete;
 
+        // Perform the handshake and send the dummy data on the connected TLS stream
+        template<class Stream>
+        boost::asio::awaitable<core::Expect<void>> exchange(Stream& stream, ClientOptions const& options,
+                                                            VirtualUser& user);
+
     public:
         ClientConnection(ClientConnection&& other);
         ClientConnection& operator=(ClientConnection&& other);
-        static core::Expect<void> sendDummyData(std::string const& serverHost, uint16_t serverPort,
-                                                std::string const& tlsGroup, uint32_t dummyDataLength);
+
+        // Connect to the server and send the dummy data, blocking the calling thread until the connection is closed or
+        // a stop is requested, which abandons the connection. Without `setup`, the connection resolves the server and
+        // builds its own setup around `payload`.
+        static core::Expect<void> sendDummyData(ClientOptions const& options, VirtualUser& user,
+                                                std::shared_ptr<ClientSetup> setup,
+                                                std::shared_ptr<PayloadPool const> payload,
+                                                std::stop_token stopToken = {});
+
+        // The coroutine counterpart of `sendDummyData`, running on the executor of the caller
+        static boost::asio::awaitable<core::Expect<void>>
+            sendDummyDataAsync(ClientOptions const& options, VirtualUser& user, std::shared_ptr<ClientSetup> setup,
+                               std::shared_ptr<PayloadPool const> payload);
     };
 } // namespace lily::net
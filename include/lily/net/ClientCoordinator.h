@@ -0,0 +1,64 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <memory>
+#include <sys/types.h>
+#include <vector>
+
+#include <lily/core/ErrorCode.h>
+#include <lily/net/ClientOptions.h>
+
+namespace lily::net
+{
+    /**
+     * @brief Splits the users of `client-run` between several worker processes and aggregates their results.
+     *
+     * A single process is bound by its allocator, the OpenSSL global locks and the `ClientLog` mutex. The coordinator
+     * forks `ClientOptions::processes` workers, each running its share of the users and of the rate with its own
+     * `ClientRunner` and its own `ClientLog` file. Once every worker is ready, they are started at the same moment.
+     * Each second, every worker sends its counters and the latencies it recorded over a Unix socket, and the
+     * coordinator merges them into one live view and one final result.
+     */
+    class ClientCoordinator
+    {
+    private:
+        struct Worker
+        {
+            pid_t pid;
+            boost::asio::local::stream_protocol::socket channel;
+        };
+
+        ClientOptions options;
+        std::unique_ptr<boost::asio::io_context> ioc;
+        std::vector<Worker> workers {};
+
+        ClientCoordinator(ClientOptions const& options);
+
+        // Run the share of the users of one worker, reporting to the coordinator through `channel`. Never returns.
+        [[noreturn]] static void runWorker(boost::asio::local::stream_protocol::socket&& channel,
+                                           ClientOptions const& options, uint32_t index);
+
+        // Kill the workers still running and wait for every one of them
+        void terminate();
+
+    public:
+        ClientCoordinator(ClientCoordinator const&)            = delete;
+        ClientCoordinator& operator=(ClientCoordinator const&) = delete;
+        ~ClientCoordinator();
+
+        /**
+         * @brief Forks the worker processes and waits until each one is ready to start.
+         *
+         * @param options The server, the users and the engine configuration, shared between the workers.
+         */
+        static core::Expect<std::unique_ptr<ClientCoordinator>> create(ClientOptions const& options);
+
+        /**
+         * @brief Starts every worker and prints the merged live view.
+         *
+         * Never returns, unless `ClientOptions::durationSeconds` or `ClientOptions::totalRequests` bounds the run.
+         * A bounded run stops every worker, then prints the merged summary and saves it as a JSON result file.
+         */
+        void run();
+    };
+} // namespace lily::net
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <lily/log/LogFormat.h>
+#include <lily/log/LogOverflow.h>
+
+namespace lily::net
+{
+    /**
+     * @brief How the client resumes its previous TLS sessions.
+     */
+    enum class ResumptionMode : uint8_t
+    {
+        LILY_RESUMPTION_NONE,   // Every request performs a full handshake
+        LILY_RESUMPTION_TICKET, // Resume with the stateless ticket issued by the server
+        LILY_RESUMPTION_CACHE   // Resume with the session id stored in the server stateful cache
+    };
+
+    /**
+     * @brief How the arrivals of the open-loop load are spaced.
+     */
+    enum class ArrivalMode : uint8_t
+    {
+        LILY_ARRIVAL_CONSTANT, // The arrivals are evenly spaced
+        LILY_ARRIVAL_POISSON   // The gaps between the arrivals are exponentially distributed
+    };
+
+    /**
+     * @brief How the size of the dummy body of each request is drawn.
+     */
+    enum class PayloadDistribution : uint8_t
+    {
+        LILY_PAYLOAD_FIXED,     // Every body has the data length
+        LILY_PAYLOAD_UNIFORM,   // Uniform between the minimum length and the data length
+        LILY_PAYLOAD_LOGNORMAL, // Log-normal with the data length as median, up to the maximum length
+        LILY_PAYLOAD_EMPIRICAL  // Weighted by the histogram file
+    };
+
+    /**
+     * @brief The configuration shared by every user of `client-run`.
+     */
+    struct ClientOptions
+    {
+        // The server to test
+        std::string serverHost {};
+        uint16_t serverPort {};
+
+        // The number of users connecting to the server at the same time
+        uint32_t concurrentUsers {};
+
+        // The number of threads, each running its share of the users as coroutines on its own `io_context`. Zero
+        // gives every user its own thread instead.
+        uint32_t threads {};
+
+        // The number of worker processes sharing the users and the rate, each with its own engine and log file. One
+        // runs every user in this process.
+        uint32_t processes {1};
+
+        // The run stops after this time, in seconds, or after this number of answered or failed requests. Zero runs
+        // until interrupted.
+        uint32_t durationSeconds {};
+        uint64_t totalRequests {};
+
+        // The number of connections started per second regardless of the completions, with the users as the maximum
+        // in flight. Zero keeps the closed loop, each user starting its next connection once the previous one is done.
+        double rate {};
+
+        // How the arrivals of the open-loop load are spaced
+        ArrivalMode arrival {ArrivalMode::LILY_ARRIVAL_CONSTANT};
+
+        // The TLS group used for the key exchange
+        std::string tlsGroup {};
+
+        // The signature algorithms offered to the server. Empty offers `SUPPORTED_SIGALGS_LIST`.
+        std::string sigalgs {};
+
+        // The SNI sent to the server, which names the certificate of a server started with a certificate directory.
+        // Empty sends no SNI.
+        std::string serverName {};
+
+        // The size of the dummy body sent on each request, or the parameter of its distribution
+        uint32_t dummyDataLength {};
+
+        // How the size of each body is drawn, with the bounds of the uniform and log-normal distributions. A zero
+        // maximum is 16 times the data length.
+        PayloadDistribution payloadDistribution {PayloadDistribution::LILY_PAYLOAD_FIXED};
+        uint32_t payloadMinLength {};
+        uint32_t payloadMaxLength {};
+
+        // The standard deviation of the logarithm of the log-normal sizes
+        double payloadSigma {1.0};
+
+        // The file of the empirical distribution, one `size;weight` line per size
+        std::string payloadHistogramFile {};
+
+        // The number of requests sent over each connection before closing it, zero for unlimited
+        uint32_t requestsPerConnection {1};
+
+        // The number of requests sent ahead of their responses on a connection
+        uint32_t pipelineDepth {1};
+
+        // Whether each user keeps and reuses its last TLS session
+        ResumptionMode resumption {ResumptionMode::LILY_RESUMPTION_NONE};
+
+        // Whether each connection resolves the server, builds its TLS context and its request again, instead of sharing
+        // the ones built once for the run
+        bool coldSetup {};
+
+        // Whether the records are encrypted by the kernel (kTLS) once the handshake is done, when supported
+        bool ktls {};
+
+        // What a user does when its buffer of log records is full
+        log::LogOverflow logOverflow {log::LogOverflow::LILY_LOG_OVERFLOW_BLOCK};
+
+        // Whether the log records are CSV lines or binary records
+        log::LogFormat logFormat {log::LogFormat::LILY_LOG_FORMAT_CSV};
+    };
+} // namespace lily::net
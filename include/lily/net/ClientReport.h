@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include <lily/log/LatencyHistogram.h>
+#include <lily/net/ClientOptions.h>
+
+namespace lily::net
+{
+    /**
+     * @brief The counters of a client run, since its start.
+     */
+    struct ClientCounters
+    {
+        int64_t successfulRequest {};
+        int64_t failedRequest {};
+
+        // The open-loop arrivals that started later than scheduled, or never started because every user was busy
+        int64_t lateArrival {};
+        int64_t droppedArrival {};
+
+        ClientCounters& operator+=(ClientCounters const& other);
+    };
+
+    /**
+     * @brief Prints the live view of a client run and its final summary.
+     *
+     * The latencies recorded since the last report are added to `getInterval()`, then `report` prints them along with
+     * the cumulative ones and folds them into the cumulative histograms. The same view is used whether the users run
+     * in this process or in the worker processes of a `ClientCoordinator`.
+     */
+    class ClientReport
+    {
+    private:
+        ClientOptions options;
+        std::unique_ptr<log::RequestHistograms> interval;
+        std::unique_ptr<log::RequestHistograms> cumulative;
+
+        std::chrono::steady_clock::time_point startTime;
+        std::chrono::steady_clock::time_point lastReportTime;
+        int64_t lastSuccessfulRequest {};
+
+    public:
+        ClientReport(ClientOptions const& options);
+
+        // The histograms to add the latencies recorded since the last report to
+        log::RequestHistograms& getInterval()
+        {
+            return *this->interval;
+        }
+
+        // Whether the run reached its `ClientOptions::durationSeconds` or `ClientOptions::totalRequests`
+        bool isFinished(ClientCounters const& counters) const;
+
+        // Whether the next periodic report is due
+        bool isReportDue() const;
+
+        // Print the counters and the interval and cumulative percentiles, then start a new interval
+        void report(ClientCounters const& counters);
+
+        // Print the summary of the finished run and save it as a JSON result file
+        void writeResult(ClientCounters const& counters);
+    };
+} // namespace lily::net
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include <boost/asio.hpp>
+#include <mutex>
+#include <thread>
+
+#include <lily/core/ErrorCode.h>
+#include <lily/log/LatencyHistogram.h>
+#include <lily/net/ClientOptions.h>
+#include <lily/net/ClientReport.h>
+#include <lily/net/ClientSetup.h>
+#include <lily/net/VirtualUser.h>
+
+namespace lily::net
+{
+    /**
+     * @brief Drives the concurrent users of `client-run` against the server.
+     *
+     * When `ClientOptions::threads` is zero, every user gets its own thread sending its requests synchronously.
+     * Otherwise the users are coroutines spread over one `io_context` per thread, so thousands of them only need a
+     * few threads. Both engines log the same `ClientLog` rows.
+     *
+     * With `ClientOptions::rate`, the load is open-loop: the connections start on a fixed schedule, independent of
+     * the responses, and their latency is measured from their scheduled start, so a slow server can't hide its
+     * queueing delay by slowing down the client (coordinated omission).
+     */
+    class ClientRunner
+    {
+        ClientOptions options;
+
+        // The setup shared by every connection, null with `ClientOptions::coldSetup`
+        std::shared_ptr<ClientSetup> setup;
+
+        // The dummy bodies, filled once per run even when each connection builds its own setup
+        std::shared_ptr<PayloadPool const> payload;
+
+        // Record total request
+        std::atomic_int64_t totalSuccessfulRequest {};
+        std::atomic_int64_t totalFailedRequest {};
+
+        // The open-loop arrivals that started later than scheduled, or never started because every user was busy
+        std::atomic_int64_t totalLateArrival {};
+        std::atomic_int64_t totalDroppedArrival {};
+
+        // The latency histograms of each thread, drained by the reporter
+        std::mutex histogramsMtx;
+        std::vector<std::unique_ptr<log::RequestHistograms>> threadHistograms {};
+
+        // The engine running the users once started, the contexts are only used by the coroutines
+        std::vector<std::unique_ptr<boost::asio::io_context>> contexts {};
+        std::vector<std::jthread> workers {};
+
+        // The idle users and the pending arrivals of one `io_context` in open loop
+        struct ArrivalQueue;
+
+        // Create the histograms recorded by the users of one thread
+        log::RequestHistograms* addThreadHistograms();
+
+        // Start every user on its own thread, until a stop is requested
+        std::vector<std::jthread> spawnThreadPerUser();
+
+        // Spread the users over one `io_context` per thread, without running them yet
+        std::vector<std::unique_ptr<boost::asio::io_context>> spawnAsync();
+
+        // Run each `io_context` on its own thread
+        static std::vector<std::jthread> runContexts(std::vector<std::unique_ptr<boost::asio::io_context>>& contexts);
+
+        // Send the requests of one closed-loop user, until its `io_context` is stopped
+        boost::asio::awaitable<void> runUserAsync(log::RequestHistograms* histograms);
+
+        // Start the connections of one `io_context` at the given rate, each on an idle user, whatever the completions
+        boost::asio::awaitable<void> scheduleArrivals(double rate, uint32_t users, log::RequestHistograms* histograms);
+        boost::asio::awaitable<void> serveArrivals(ArrivalQueue& queue, VirtualUser& user,
+                                                   std::chrono::steady_clock::time_point scheduledStart);
+
+        ClientRunner(ClientOptions const& options, std::shared_ptr<ClientSetup> setup,
+                     std::shared_ptr<PayloadPool const> payload);
+
+    public:
+        /**
+         * @brief What the server sustained during one measurement window.
+         */
+        struct Measurement
+        {
+            // The offered rate of connections, in connections per second
+            double offeredRate {};
+
+            // The successful requests per second
+            double tps {};
+
+            // The failed requests and the dropped arrivals, over every request and arrival of the window
+            double errorRate {};
+
+            // The latency percentiles, in µs
+            uint64_t p50LatencyUs {};
+            uint64_t p99LatencyUs {};
+            uint64_t p50HandshakeUs {};
+            uint64_t p99HandshakeUs {};
+
+            // The bytes of the TLS records sent and received by each handshake on average, headers included
+            double handshakeBytesSent {};
+            double handshakeBytesReceived {};
+        };
+
+        ClientRunner(ClientRunner const&)            = delete;
+        ClientRunner& operator=(ClientRunner const&) = delete;
+
+        /**
+         * @brief Constructs a new `ClientRunner` instance, resolving the server and building the shared setup once.
+         *
+         * @param options The server, the users and the engine configuration.
+         */
+        static core::Expect<std::unique_ptr<ClientRunner>> create(ClientOptions const& options);
+
+        /**
+         * @brief Starts every user on its engine, without waiting.
+         */
+        void start();
+
+        /**
+         * @brief Stops every user started by `start`, abandoning the connections in flight of the coroutines.
+         */
+        void stop();
+
+        /**
+         * @brief Returns the counters since the creation of the runner.
+         */
+        ClientCounters getCounters() const;
+
+        /**
+         * @brief Moves the latencies recorded by every thread to `target`.
+         */
+        void drainHistograms(log::RequestHistograms& target);
+
+        /**
+         * @brief Starts every user and prints the request counters and latency percentiles periodically.
+         *
+         * Never returns, unless `ClientOptions::durationSeconds` or `ClientOptions::totalRequests` bounds the run.
+         * A bounded run stops every user, then prints its summary and saves it as a JSON result file.
+         */
+        void run();
+
+        /**
+         * @brief Offers the given open-loop rate, then stops every user and reports the window after the warm-up.
+         *
+         * @param rate The number of connections started per second, zero for the closed loop of the users.
+         * @param warmUp The time given to the server to reach its steady state, not measured.
+         * @param window The time measured once warmed up.
+         */
+        Measurement measure(double rate, std::chrono::seconds warmUp, std::chrono::seconds window);
+    };
+} // namespace lily::net
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <memory>
+#include <string>
+
+#include <lily/core/ErrorCode.h>
+#include <lily/net/ClientOptions.h>
+#include <lily/net/PayloadPool.h>
+
+namespace lily::net
+{
+    /**
+     * @brief Everything a client connection needs that doesn't depend on the connection itself.
+     *
+     * The TLS context, the resolved server endpoints and the serialized request are built once per run and shared
+     * read-only by every user, so none of them is rebuilt inside the timed loop. With `ClientOptions::coldSetup`, each
+     * connection builds its own setup instead, to measure that cost on purpose. The payload pool isn't part of that
+     * cost, it is filled once per run and shared by every setup.
+     */
+    class ClientSetup
+    {
+    private:
+        ClientSetup(std::shared_ptr<PayloadPool const> payload);
+
+    public:
+        // The TLS 1.3 context with the group and signature algorithms of the options
+        boost::asio::ssl::context ctx;
+
+        // The endpoints of the server, tried in order
+        boost::asio::ip::tcp::resolver::results_type endpoints {};
+
+        // The serialized request header, asking to keep the connection open or to close it. Each request completes it
+        // with the `Content-Length` of its body and the empty line.
+        std::string keepAliveHeader {};
+        std::string closeHeader {};
+
+        // The dummy bodies sent after the header, shared by every setup of the run
+        std::shared_ptr<PayloadPool const> payload;
+
+        ClientSetup(ClientSetup const&)            = delete;
+        ClientSetup& operator=(ClientSetup const&) = delete;
+
+        /**
+         * @brief Resolves the server host and port of the options, blocking the calling thread.
+         */
+        static core::Expect<boost::asio::ip::tcp::resolver::results_type> resolve(ClientOptions const& options);
+
+        /**
+         * @brief Builds the TLS context and the request template for the options.
+         *
+         * @param options The client configuration.
+         * @param endpoints The resolved endpoints of the server.
+         * @param payload The dummy bodies of the run, see `PayloadPool::create`.
+         */
+        static core::Expect<std::shared_ptr<ClientSetup>>
+            create(ClientOptions const& options, boost::asio::ip::tcp::resolver::results_type endpoints,
+                   std::shared_ptr<PayloadPool const> payload);
+    };
+} // namespace lily::net
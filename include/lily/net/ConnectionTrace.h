@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <openssl/ssl.h>
+
+#include <lily/log/ConnectionContext.h>
+#include <lily/log/HandshakePhases.h>
+#include <lily/log/HandshakeTraffic.h>
+#include <lily/log/NegotiatedParameters.h>
+
+namespace lily::net
+{
+    /**
+     * @brief Timestamps the handshake messages of one `SSL` object through the OpenSSL message and info callbacks.
+     *
+     * The message callback also sees the header of every TLS record, so the trace counts the records and the bytes of
+     * the handshake. The callbacks are removed once the handshake is done, so the records of the application data
+     * never go through them, and the messages only cost a clock read each. The trace must not move while attached to
+     * its `SSL` object.
+     *
+     * The callbacks also make the context of the connection current on the thread advancing the handshake, until
+     * OpenSSL returns, so the primitives are attributed to the right connection whichever thread runs each step.
+     */
+    class ConnectionTrace
+    {
+    private:
+        // The traced messages, in the order of a TLS 1.3 handshake
+        enum Message
+        {
+            LILY_MESSAGE_CLIENT_HELLO,
+            LILY_MESSAGE_SERVER_HELLO,
+            LILY_MESSAGE_ENCRYPTED_EXTENSIONS,
+            LILY_MESSAGE_CERTIFICATE,
+            LILY_MESSAGE_CERTIFICATE_VERIFY,
+            LILY_MESSAGE_SERVER_FINISHED,
+            LILY_MESSAGE_CLIENT_FINISHED,
+            LILY_MESSAGE_COUNT
+        };
+
+        SSL* ssl;
+
+        std::chrono::high_resolution_clock::time_point beginHandshake;
+
+        // When each message was last sent or received, unset if it wasn't
+        std::array<std::chrono::high_resolution_clock::time_point, LILY_MESSAGE_COUNT> messages {};
+
+        log::HandshakeTraffic traffic {};
+        log::ConnectionContext context {};
+
+        // The `SSL` ex data holding the trace attached to the object, for the info callback
+        static int getIndex();
+
+        // Detach the callbacks from the `SSL` object
+        void detach();
+
+        // Make the context of the connection current on the calling thread, or stop it being current
+        void enter();
+        void leave();
+
+        static void onMessage(int writeP, int version, int contentType, void const* buf, std::size_t len, SSL* ssl,
+                              void* arg);
+        static void onInfo(SSL const* ssl, int where, int ret);
+
+    public:
+        /**
+         * @brief Attaches the trace to `ssl`, the handshake is timed from now.
+         */
+        explicit ConnectionTrace(SSL* ssl);
+        ~ConnectionTrace();
+
+        ConnectionTrace(ConnectionTrace const&)            = delete;
+        ConnectionTrace& operator=(ConnectionTrace const&) = delete;
+
+        /**
+         * @brief Returns the time spent in each phase of the handshake, once done.
+         */
+        log::HandshakePhases getPhases() const;
+
+        /**
+         * @brief Returns the records sent and received until the handshake was done.
+         */
+        log::HandshakeTraffic getTraffic() const
+        {
+            return this->traffic;
+        }
+
+        /**
+         * @brief Returns the id of the connection and the time its handshake spent in the liboqs primitives.
+         */
+        log::ConnectionContext getContext() const
+        {
+            return this->context;
+        }
+
+        /**
+         * @brief Returns the group, the signature algorithm and the cipher agreed on by the handshake.
+         */
+        log::NegotiatedParameters getParameters() const;
+    };
+} // namespace lily::net
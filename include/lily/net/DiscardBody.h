@@ -0,0 +1,55 @@
+#pragma once
+
+#include <boost/beast.hpp>
+
+namespace lily::net
+{
+    /**
+     * @brief A Beast body that only counts the received bytes and drops them.
+     *
+     * The client never inspects the echoed body, so reading it into a `dynamic_body` would only cost memory
+     * proportional to the payload size.
+     */
+    struct DiscardBody
+    {
+        // The number of body bytes received
+        using value_type = uint64_t;
+
+        static uint64_t size(value_type const& body)
+        {
+            return body;
+        }
+
+        class reader
+        {
+        private:
+            value_type& body;
+
+        public:
+            template<bool isRequest, class Fields>
+            explicit reader(boost::beast::http::header<isRequest, Fields>&, value_type& body): body(body)
+            {
+            }
+
+            void init(boost::optional<uint64_t> const&, boost::beast::error_code& ec)
+            {
+                this->body = 0;
+                ec         = {};
+            }
+
+            template<class ConstBufferSequence>
+            std::size_t put(ConstBufferSequence const& buffers, boost::beast::error_code& ec)
+            {
+                auto size {boost::asio::buffer_size(buffers)};
+                this->body += size;
+                ec = {};
+                return size;
+            }
+
+            void finish(boost::beast::error_code& ec)
+            {
+                ec = {};
+            }
+        };
+    };
+} // namespace lily::net
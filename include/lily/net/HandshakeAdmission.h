@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <boost/asio.hpp>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+#include <lily/net/ServerOptions.h>
+
+namespace lily::net
+{
+    /**
+     * @brief Bounds the number of TLS handshakes running at the same time.
+     *
+     * A slot is acquired before the handshake and released right after it, so the CPU-heavy PQC handshakes can't
+     * starve each other under saturation. The counters record how the connections were admitted.
+     */
+    class HandshakeAdmission
+    {
+    private:
+        uint32_t maxInFlight;
+        uint32_t maxQueued;
+        OverflowPolicy policy;
+
+        std::mutex mtx;
+        std::condition_variable cv;
+        uint32_t inFlight {};
+        std::deque<std::function<void()>> waiters {};
+
+        std::atomic_uint64_t admittedCount {};
+        std::atomic_uint64_t queuedCount {};
+        std::atomic_uint64_t shedCount {};
+
+        enum class Decision : uint8_t
+        {
+            ADMIT,
+            WAIT,
+            SHED
+        };
+
+        // Decide what to do with a new connection, `mtx` must be held
+        Decision decide();
+
+    public:
+        HandshakeAdmission(uint32_t maxInFlight, uint32_t maxQueued, OverflowPolicy policy);
+
+        // Create the admission configured by the server options, or nothing if the handshakes are unlimited
+        static std::unique_ptr<HandshakeAdmission> create(ServerOptions const& options);
+        HandshakeAdmission(HandshakeAdmission const&)            = delete;
+        HandshakeAdmission& operator=(HandshakeAdmission const&) = delete;
+
+        OverflowPolicy getPolicy() const
+        {
+            return this->policy;
+        }
+
+        /**
+         * @brief Acquires a handshake slot, blocking the calling thread while the connection is queued.
+         *
+         * @return `false` if the connection must be shed.
+         */
+        bool acquire();
+
+        /**
+         * @brief Acquires a handshake slot without blocking the worker thread while the connection is queued. The
+         * calling coroutine must run on a strand.
+         *
+         * @return `false` if the connection must be shed.
+         */
+        boost::asio::awaitable<bool> asyncAcquire();
+
+        /**
+         * @brief Releases the slot, handing it over to the oldest queued connection if any.
+         */
+        void release();
+
+        // Close the socket with a TCP reset instead of the usual FIN
+        static void reset(boost::asio::ip::tcp::socket& socket);
+
+        uint64_t getAdmittedCount() const
+        {
+            return this->admittedCount.load(std::memory_order_relaxed);
+        }
+        uint64_t getQueuedCount() const
+        {
+            return this->queuedCount.load(std::memory_order_relaxed);
+        }
+        uint64_t getShedCount() const
+        {
+            return this->shedCount.load(std::memory_order_relaxed);
+        }
+        uint32_t getInFlight();
+    };
+} // namespace lily::net
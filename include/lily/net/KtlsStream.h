@@ -0,0 +1,220 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+namespace lily::net
+{
+    /**
+     * @brief A TLS stream whose `SSL` object does the socket I/O by itself.
+     *
+     * `boost::asio::ssl::stream` feeds OpenSSL through a memory BIO pair, which keeps the record layer in user space.
+     * OpenSSL can only move the record encryption into the kernel (kTLS) when its BIO is the socket, so this stream
+     * calls `SSL_*` directly on the non-blocking socket and waits for the socket readiness whenever OpenSSL asks for
+     * it. It satisfies the synchronous and asynchronous read and write stream concepts of Asio, so Beast can use it.
+     */
+    class KtlsStream
+    {
+    public:
+        using executor_type   = boost::asio::ip::tcp::socket::executor_type;
+        using next_layer_type = boost::asio::ip::tcp::socket;
+
+    private:
+        boost::asio::ip::tcp::socket socket;
+        std::unique_ptr<SSL, decltype(&SSL_free)> ssl;
+
+        // Translate the result of an `SSL_*` call. Returns true if the call must be retried once the socket is ready
+        // for `wait`, otherwise `ec` holds the outcome of the call.
+        bool shouldRetry(int result, boost::asio::socket_base::wait_type& wait, boost::system::error_code& ec) const;
+
+        // Attach the socket to the `SSL` object, set up for kTLS and for the given side of the handshake
+        void prepare(boost::asio::ssl::stream_base::handshake_type type, boost::system::error_code& ec);
+
+        // Run `operation` until it completes, blocking on the socket readiness in between
+        template<class Operation>
+        std::size_t perform(Operation&& operation, boost::system::error_code& ec)
+        {
+            boost::asio::socket_base::wait_type wait {};
+            while (true)
+            {
+                ERR_clear_error();
+                std::size_t size {};
+                auto result {operation(size)};
+                if (!this->shouldRetry(result, wait, ec))
+                    return ec ? 0 : size;
+                std::ignore = this->socket.wait(wait, ec);
+                if (ec)
+                    return 0;
+            }
+        }
+
+        // Run `operation` until it completes, waiting asynchronously on the socket readiness in between
+        template<class Operation, class CompletionToken>
+        auto asyncPerform(Operation operation, CompletionToken&& token)
+        {
+            return boost::asio::async_compose<CompletionToken, void(boost::system::error_code, std::size_t)>(
+                [this, operation](auto& self, boost::system::error_code ec = {}) mutable
+                {
+                    if (ec)
+                        return self.complete(ec, 0);
+
+                    ERR_clear_error();
+                    std::size_t size {};
+                    auto result {operation(size)};
+                    boost::asio::socket_base::wait_type wait {};
+                    if (this->shouldRetry(result, wait, ec))
+                        return this->socket.async_wait(wait, std::move(self));
+                    self.complete(ec, ec ? 0 : size);
+                },
+                token, this->socket);
+        }
+
+    public:
+        // Take ownership of the connected socket and of one reference of `ssl`
+        KtlsStream(boost::asio::ip::tcp::socket&& socket, SSL* ssl);
+        KtlsStream(KtlsStream&&)                 = default;
+        KtlsStream& operator=(KtlsStream&&)      = default;
+        KtlsStream(KtlsStream const&)            = delete;
+        KtlsStream& operator=(KtlsStream const&) = delete;
+
+        executor_type get_executor()
+        {
+            return this->socket.get_executor();
+        }
+        boost::asio::ip::tcp::socket& next_layer()
+        {
+            return this->socket;
+        }
+        SSL* native_handle()
+        {
+            return this->ssl.get();
+        }
+
+        // Whether the kernel encrypts the sent records and decrypts the received ones. Both are only known once the
+        // handshake is done, and stay false when kTLS isn't available for the negotiated cipher.
+        bool isKtlsSend() const;
+        bool isKtlsRecv() const;
+
+        // Attach the socket to the `SSL` object and perform the handshake. Returns `ec`, like the Asio stream.
+        boost::system::error_code handshake(boost::asio::ssl::stream_base::handshake_type type,
+                                            boost::system::error_code& ec);
+
+        // Send the close notify and wait for the one of the peer. Returns `ec`, like the Asio stream.
+        boost::system::error_code shutdown(boost::system::error_code& ec);
+
+        // The asynchronous counterparts of `handshake` and `shutdown`, completing with `void(error_code)`
+        template<class HandshakeToken>
+        auto async_handshake(boost::asio::ssl::stream_base::handshake_type type, HandshakeToken&& token)
+        {
+            boost::system::error_code ec {};
+            this->prepare(type, ec);
+            return boost::asio::async_initiate<HandshakeToken, void(boost::system::error_code)>(
+                [this, ec](auto handler)
+                {
+                    // A preparation failure still goes through the composed operation, so the handler is never
+                    // invoked from the initiation
+                    this->asyncPerform(
+                        [this, ec](std::size_t&) { return ec ? 1 : SSL_do_handshake(this->ssl.get()); },
+                        [ec, handler {std::move(handler)}](boost::system::error_code result, std::size_t) mutable
+                        { std::move(handler)(ec ? ec : result); });
+                },
+                token);
+        }
+
+        template<class ShutdownToken>
+        auto async_shutdown(ShutdownToken&& token)
+        {
+            return boost::asio::async_initiate<ShutdownToken, void(boost::system::error_code)>(
+                [this](auto handler)
+                {
+                    this->asyncPerform(
+                        [this](std::size_t&)
+                        {
+                            auto result {SSL_shutdown(this->ssl.get())};
+                            return result == 0 ? SSL_shutdown(this->ssl.get()) : result;
+                        },
+                        [handler {std::move(handler)}](boost::system::error_code ec, std::size_t) mutable
+                        { std::move(handler)(ec); });
+                },
+                token);
+        }
+
+        template<class MutableBufferSequence>
+        std::size_t read_some(MutableBufferSequence const& buffers, boost::system::error_code& ec)
+        {
+            auto buffer {boost::asio::detail::buffer_sequence_adapter<boost::asio::mutable_buffer,
+                                                                      MutableBufferSequence>::first(buffers)};
+            if (buffer.size() == 0)
+                return ec = {}, 0;
+            return this->perform([&](std::size_t& size)
+                                 { return SSL_read_ex(this->ssl.get(), buffer.data(), buffer.size(), &size); },
+                                 ec);
+        }
+        template<class MutableBufferSequence>
+        std::size_t read_some(MutableBufferSequence const& buffers)
+        {
+            boost::system::error_code ec {};
+            auto size {this->read_some(buffers, ec)};
+            boost::asio::detail::throw_error(ec, "read_some");
+            return size;
+        }
+
+        template<class ConstBufferSequence>
+        std::size_t write_some(ConstBufferSequence const& buffers, boost::system::error_code& ec)
+        {
+            auto buffer {boost::asio::detail::buffer_sequence_adapter<boost::asio::const_buffer,
+                                                                      ConstBufferSequence>::first(buffers)};
+            if (buffer.size() == 0)
+                return ec = {}, 0;
+            return this->perform([&](std::size_t& size)
+                                 { return SSL_write_ex(this->ssl.get(), buffer.data(), buffer.size(), &size); },
+                                 ec);
+        }
+        template<class ConstBufferSequence>
+        std::size_t write_some(ConstBufferSequence const& buffers)
+        {
+            boost::system::error_code ec {};
+            auto size {this->write_some(buffers, ec)};
+            boost::asio::detail::throw_error(ec, "write_some");
+            return size;
+        }
+
+        template<class MutableBufferSequence, class ReadToken>
+        auto async_read_some(MutableBufferSequence const& buffers, ReadToken&& token)
+        {
+            auto buffer {boost::asio::detail::buffer_sequence_adapter<boost::asio::mutable_buffer,
+                                                                      MutableBufferSequence>::first(buffers)};
+            return this->asyncPerform(
+                [ssl {this->ssl.get()}, buffer](std::size_t& size)
+                { return buffer.size() == 0 ? 1 : SSL_read_ex(ssl, buffer.data(), buffer.size(), &size); },
+                std::forward<ReadToken>(token));
+        }
+
+        template<class ConstBufferSequence, class WriteToken>
+        auto async_write_some(ConstBufferSequence const& buffers, WriteToken&& token)
+        {
+            auto buffer {boost::asio::detail::buffer_sequence_adapter<boost::asio::const_buffer,
+                                                                      ConstBufferSequence>::first(buffers)};
+            return this->asyncPerform(
+                [ssl {this->ssl.get()}, buffer](std::size_t& size)
+                { return buffer.size() == 0 ? 1 : SSL_write_ex(ssl, buffer.data(), buffer.size(), &size); },
+                std::forward<WriteToken>(token));
+        }
+
+        /**
+         * @brief Reports whether kTLS offloads the sending and the receiving of `stream`.
+         *
+         * Always false for the streams keeping the record layer in user space.
+         */
+        template<class Stream>
+        static std::pair<bool, bool> getOffload(Stream& stream)
+        {
+            if constexpr (std::is_same_v<Stream, KtlsStream>)
+                return {stream.isKtlsSend(), stream.isKtlsRecv()};
+            else
+                return {false, false};
+        }
+    };
+} // namespace lily::net
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+#include <thread>
+
+namespace lily::net
+{
+    /**
+     * @brief Serves the `ServerMetrics` in plain HTTP, on its own thread, for a Prometheus scraper.
+     *
+     * `GET /metrics` returns the merged metrics in the Prometheus text format, any other target a 404. The scrapes
+     * are served one at a time, each on its own connection, so the endpoint never competes with the TLS workers for
+     * more than one thread.
+     */
+    class MetricsEndpoint
+    {
+    private:
+        std::unique_ptr<boost::beast::net::io_context> ioc;
+        boost::asio::ip::tcp::acceptor acceptor;
+
+        // Declared last, so the thread is joined before the `io_context` is destroyed
+        std::jthread thread {};
+
+        boost::asio::awaitable<void> acceptScrapes();
+        boost::asio::awaitable<void> serveScrape(boost::asio::ip::tcp::socket socket);
+
+    public:
+        MetricsEndpoint();
+        MetricsEndpoint(MetricsEndpoint const&)            = delete;
+        MetricsEndpoint& operator=(MetricsEndpoint const&) = delete;
+        ~MetricsEndpoint()
+        {
+            this->ioc->stop();
+        }
+
+        boost::asio::ip::tcp::acceptor& getAcceptor()
+        {
+            return this->acceptor;
+        }
+
+        // Start serving the scrapes on the endpoint thread. The acceptor must be listening.
+        void start();
+    };
+} // namespace lily::net
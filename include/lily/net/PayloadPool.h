@@ -0,0 +1,63 @@
+#pragma once
+
+#include <boost/asio/buffer.hpp>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <lily/core/ErrorCode.h>
+#include <lily/net/ClientOptions.h>
+
+namespace lily::net
+{
+    /**
+     * @brief The dummy bodies of the client requests, drawn from one random buffer allocated once.
+     *
+     * A constant body compresses trivially, so the buffer is filled with random bytes. Each request draws its size
+     * from the `ClientOptions::payloadDistribution` and sends a slice of the buffer at a random offset, without any
+     * allocation or copy. The pool is shared read-only by every user, each one drawing with its own generator.
+     */
+    class PayloadPool
+    {
+    private:
+        PayloadDistribution distribution {};
+        uint32_t minLength {};
+        uint32_t maxLength {};
+        std::lognormal_distribution<double>::param_type lognormal {};
+
+        // The sizes of the empirical distribution and their weights
+        std::vector<uint32_t> empiricalSizes {};
+        std::discrete_distribution<std::size_t>::param_type empiricalWeights {};
+
+        std::vector<char> buffer {};
+
+        PayloadPool() = default;
+
+        // Read the `size;weight` lines of the empirical distribution
+        core::Expect<void> loadHistogram(std::string const& fileName);
+
+    public:
+        // The range of the random offset of the slices, so consecutive bodies of the same size differ
+        static constexpr std::size_t OFFSET_RANGE {64 * 1024};
+
+        PayloadPool(PayloadPool&&)                 = default;
+        PayloadPool& operator=(PayloadPool&&)      = default;
+        PayloadPool(PayloadPool const&)            = delete;
+        PayloadPool& operator=(PayloadPool const&) = delete;
+
+        /**
+         * @brief Builds the distribution of the options and fills the buffer for its largest size.
+         */
+        static core::Expect<PayloadPool> create(ClientOptions const& options);
+
+        /**
+         * @brief Draws the size of the next body.
+         */
+        uint32_t drawSize(std::mt19937_64& generator) const;
+
+        /**
+         * @brief Returns a slice of the buffer of the given size, no larger than the largest size of the distribution.
+         */
+        boost::asio::const_buffer getSlice(uint32_t size, std::mt19937_64& generator) const;
+    };
+} // namespace lily::net
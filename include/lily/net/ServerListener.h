@@ -6,6 +6,11 @@
 #include <filesystem>
 
 #include <lily/core/ErrorCode.h>
+#include <lily/net/CertificateStore.h>
+#include <lily/net/HandshakeAdmission.h>
+#include <lily/net/MetricsEndpoint.h>
+#include <lily/net/ServerOptions.h>
+#include <lily/net/ServerShard.h>
 
 namespace lily::net
 {
@@ -22,24 +27,58 @@ namespace lily::net
         boost::asio::ssl::context ctx;
         boost::asio::ip::tcp::endpoint endpoint;
         boost::asio::ip::tcp::acceptor acceptor;
+        ServerOptions options;
+        std::vector<std::unique_ptr<ServerShard>> shards {};
+        std::unique_ptr<HandshakeAdmission> admission {};
+        std::unique_ptr<CertificateStore> certificates {};
+        std::unique_ptr<MetricsEndpoint> metrics {};
 
         /**
          * @brief Constructs the required object for a new `ServerListener` instance.
          */
-        ServerListener(uint16_t port);
+        ServerListener(ServerOptions const& options);
+
+        // Open, bind and listen to the given endpoint
+        static core::Expect<void> openAcceptor(boost::asio::ip::tcp::acceptor& acceptor,
+                                               boost::asio::ip::tcp::endpoint const& endpoint, bool reusePort);
+
+        // Load the certificate and private key, or attach the certificate store if any, then apply the TLS 1.3 and
+        // PQC configuration
+        static core::Expect<void> configureContext(boost::asio::ssl::context& ctx, ServerOptions const& options,
+                                                   CertificateStore const* certificates);
+
+        // Accept each connection on its own thread and serve it with the synchronous `ServerSession`
+        void runThreadPerConnection();
+
+        // Accept and serve every connection asynchronously on the worker threads sharing `ioc`
+        void runAsync();
+        boost::asio::awaitable<void> acceptAsync();
+
+        // Run every shard on its own pinned thread and report their counters
+        void runSharded();
+
+        // Print the hit rates of the `SessionPool`, if enabled
+        static void reportPool();
 
     public:
         ServerListener(ServerListener&& other):
             ioc(std::move(other.ioc)), ctx(std::move(other.ctx)), endpoint(std::move(other.endpoint)),
-            acceptor(std::move(other.acceptor))
+            acceptor(std::move(other.acceptor)), options(std::move(other.options)),
+            shards(std::move(other.shards)), admission(std::move(other.admission)),
+            certificates(std::move(other.certificates)), metrics(std::move(other.metrics))
         {
         }
         ServerListener& operator=(ServerListener&& other)
         {
-            this->ioc      = std::move(other.ioc);
-            this->ctx      = std::move(other.ctx);
-            this->endpoint = std::move(other.endpoint);
-            this->acceptor = std::move(other.acceptor);
+            this->ioc          = std::move(other.ioc);
+            this->ctx          = std::move(other.ctx);
+            this->endpoint     = std::move(other.endpoint);
+            this->acceptor     = std::move(other.acceptor);
+            this->options      = std::move(other.options);
+            this->shards       = std::move(other.shards);
+            this->admission    = std::move(other.admission);
+            this->certificates = std::move(other.certificates);
+            this->metrics      = std::move(other.metrics);
             return *this;
         }
         ServerListener(ServerListener const&)            = delete;
@@ -48,17 +87,19 @@ namespace lily::net
         /**
          * @brief Constructs a new `ServerListener` instance.
          *
-         * @param port The port number to listen on.
+         * @param options The listener port, certificate, private key and engine configuration.
          */
-        static core::Expect<ServerListener> create(uint16_t port, std::filesystem::path const& serverCertificatePath,
-                                                   std::filesystem::path const& privateKeyPath);
+        static core::Expect<ServerListener> create(ServerOptions const& options);
 
         /**
          * @brief Starts listening for incoming connections.
          *
          * This method initializes the network listener and begins accepting incoming
          * connections. It should be called after constructing an instance of
-         * `ServerListener`.
+         * `ServerListener`. When `ServerOptions::threads` is zero, every connection gets its own thread, otherwise
+         * the connections are served asynchronously by the worker thread pool. With `ServerOptions::shards`, every
+         * shard accepts and serves its own connections instead. With `ServerOptions::metricsPort`, the metrics
+         * endpoint is served on its own thread meanwhile.
          */
         void run();
     };
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <boost/system/error_code.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <lily/log/LatencyHistogram.h>
+
+namespace lily::net
+{
+    /**
+     * @brief The live counters and latency histograms of the server, exposed by the `MetricsEndpoint`.
+     *
+     * The workers record into one of `SHARD_COUNT` shards, picked once per thread, with relaxed atomic increments and
+     * no lock. A scrape merges every shard, so it never stops the workers. Recording does nothing until `enable` is
+     * called, which the listener only does with `--metrics-port`.
+     */
+    class ServerMetrics
+    {
+    public:
+        enum Counter
+        {
+            LILY_METRIC_ACCEPTED,
+            LILY_METRIC_SHED,
+            LILY_METRIC_HANDSHAKES_STARTED,
+            LILY_METRIC_HANDSHAKES_OK,
+
+            // The failed handshakes, by error class
+            LILY_METRIC_HANDSHAKES_TRUNCATED, // The peer closed the connection without a TLS alert
+            LILY_METRIC_HANDSHAKES_RESET,     // The connection was reset or the pipe broken
+            LILY_METRIC_HANDSHAKES_TIMEOUT,   // The connection timed out
+            LILY_METRIC_HANDSHAKES_TLS,       // OpenSSL failed the handshake, usually with an alert
+            LILY_METRIC_HANDSHAKES_OTHER,
+
+            LILY_METRIC_REQUESTS,
+            LILY_METRIC_BYTES_RECEIVED,
+            LILY_METRIC_BYTES_SENT,
+            LILY_METRIC_COUNT
+        };
+
+    private:
+        // More threads than shards share the shards, which stays correct since every update is atomic
+        static constexpr std::size_t SHARD_COUNT {64};
+
+        // Aligned so two shards never share a cache line
+        struct alignas(64) Shard
+        {
+            std::array<std::atomic_uint64_t, LILY_METRIC_COUNT> counters {};
+
+            // In µs
+            log::LatencyHistogram handshake {};
+            log::LatencyHistogram read {};
+            log::LatencyHistogram write {};
+        };
+
+        // Null until enabled, so a server without the endpoint doesn't allocate the histograms
+        std::unique_ptr<std::array<Shard, SHARD_COUNT>> shards {};
+
+        ServerMetrics() = default;
+
+        ServerMetrics(ServerMetrics const&)            = delete;
+        ServerMetrics(ServerMetrics&&)                 = delete;
+        ServerMetrics& operator=(ServerMetrics const&) = delete;
+        ServerMetrics& operator=(ServerMetrics&&)      = delete;
+
+        // The shard of the calling thread
+        Shard& getShard();
+
+        uint64_t getTotal(Counter counter) const;
+
+    public:
+        static ServerMetrics& getInstance();
+
+        // Start recording. Must be called before the workers start.
+        void enable();
+        bool isEnabled() const
+        {
+            return this->shards != nullptr;
+        }
+
+        void recordAccepted();
+        void recordShed();
+        void recordHandshakeStarted();
+
+        // Count the handshake as successful, or failed with the class of `ec`
+        void recordHandshake(int64_t durationUs, boost::system::error_code const& ec);
+
+        // Count one echoed request and the HTTP bytes it read and wrote
+        void recordRequest(uint64_t readSize, int64_t readUs, uint64_t writeSize, int64_t writeUs);
+
+        /**
+         * @brief Merges every shard into the Prometheus text exposition format.
+         *
+         * The histograms are exposed in seconds. Their `le` bounds are approximated within the 3% width of the
+         * `LatencyHistogram` buckets.
+         */
+        std::string format() const;
+    };
+} // namespace lily::net
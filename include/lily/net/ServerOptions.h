@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+#include <lily/log/LogFormat.h>
+#include <lily/log/LogOverflow.h>
+
+namespace lily::net
+{
+    /**
+     * @brief What happens to a connection when every handshake slot is taken.
+     */
+    enum class OverflowPolicy : uint8_t
+    {
+        LILY_OVERFLOW_QUEUE,  // Wait in the bounded admission queue, shed the connection once the queue is full
+        LILY_OVERFLOW_REJECT, // Shed the connection immediately with a TCP reset
+        LILY_OVERFLOW_DELAY   // Stop accepting until a slot is released, leaving the connections in the kernel backlog
+    };
+
+    /**
+     * @brief The configuration used to create a `ServerListener` instance.
+     */
+    struct ServerOptions
+    {
+        // The server listener port
+        uint16_t port {};
+
+        // The port of the plain-HTTP metrics endpoint, scraped by Prometheus. Zero disables the endpoint.
+        uint16_t metricsPort {};
+
+        // The server's certificate and private key, in PEM format
+        std::filesystem::path certificatePath {};
+        std::filesystem::path privateKeyPath {};
+
+        // The directory of `<name>.crt` and `<name>.key` pairs, chosen on each handshake. Replaces the single pair
+        // above when set.
+        std::filesystem::path certificateDirectory {};
+
+        // The number of worker threads sharing one `io_context` for the asynchronous engine. Zero keeps the
+        // thread-per-connection engine.
+        uint32_t threads {};
+
+        // The number of shards, each with its own `SO_REUSEPORT` acceptor, `io_context`, TLS context and thread
+        // pinned to one core. Zero disables the sharding.
+        uint32_t shards {};
+
+        // The size of the stateful session cache. Zero keeps the resumption stateless, with the session encrypted in
+        // the ticket itself.
+        uint32_t sessionCacheSize {};
+
+        // The number of TLS 1.3 session tickets sent after each full handshake. Zero disables the resumption.
+        uint32_t sessionTickets {2};
+
+        // The maximum number of handshakes in flight. Zero leaves the handshakes unlimited. With sharding, the limit
+        // applies to each shard.
+        uint32_t maxHandshakes {};
+
+        // The capacity of the admission queue used by `OverflowPolicy::LILY_OVERFLOW_QUEUE`
+        uint32_t admissionQueueSize {1024};
+
+        // What happens to a connection when every handshake slot is taken
+        OverflowPolicy overflowPolicy {OverflowPolicy::LILY_OVERFLOW_QUEUE};
+
+        // The size of the window used to stream the echoed bodies. Zero buffers each whole body instead.
+        uint32_t streamWindow {};
+
+        // The number of `SSL` objects and read buffers recycled by each worker. Zero disables the pooling.
+        uint32_t poolSize {};
+
+        // Whether the records are encrypted by the kernel (kTLS) once the handshake is done, when supported. Only
+        // available with the thread-per-connection engine.
+        bool ktls {};
+
+        // What a connection does when its thread buffer of log records is full
+        log::LogOverflow logOverflow {log::LogOverflow::LILY_LOG_OVERFLOW_BLOCK};
+
+        // Whether the log records are CSV lines or binary records
+        log::LogFormat logFormat {log::LogFormat::LILY_LOG_FORMAT_CSV};
+    };
+} // namespace lily::net
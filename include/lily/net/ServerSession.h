@@ -4,37 +4,95 @@
 #include <boost/asio/ssl.hpp>
 #include <boost/beast.hpp>
 #include <boost/beast/http/message_generator.hpp>
-#include <boost/beast/ssl.hpp>
+#include <variant>
+
+#include <lily/log/ConnectionContext.h>
+#include <lily/log/HandshakePhases.h>
+#include <lily/log/HandshakeTraffic.h>
+#include <lily/log/NegotiatedParameters.h>
+#include <lily/net/HandshakeAdmission.h>
+#include <lily/net/KtlsStream.h>
+#include <lily/net/SessionPool.h>
 
 namespace lily::net
 {
+    /**
+     * @brief Serves one connection synchronously on its own thread.
+     *
+     * When the `SessionPool` is enabled, the `SSL` object and the read buffer are taken from the pool and handed back
+     * when the session is destroyed. With kTLS, the session runs on a `KtlsStream` instead of the Asio TLS stream.
+     */
     class ServerSession
     {
     private:
-        boost::beast::ssl_stream<boost::beast::tcp_stream> stream;
-        boost::beast::flat_buffer buffer {};
+        using SessionStream = std::variant<boost::asio::ssl::stream<boost::beast::tcp_stream>, KtlsStream>;
+
+        // Declared before the stream, so the pooled object is handed back after the stream released it
+        PooledSSL pooled;
+
+        SessionStream stream;
+        boost::beast::flat_buffer buffer;
+
+        // The handshake admission, or null if the handshakes are unlimited
+        HandshakeAdmission* admission;
+
+        // Whether the handshake slot was already acquired before accepting the connection
+        bool admitted;
+
+        // The body window of the streaming echo, empty when the whole body is buffered
+        std::vector<char> window;
+
+        // Wrap the socket with the TLS stream, using the pooled `SSL` object if any
+        static SessionStream makeStream(boost::asio::ip::tcp::socket&& socket, boost::asio::ssl::context& ctx,
+                                        SSL* ssl, bool ktls);
+
+        // Serve the connection on the selected TLS stream
+        template<class Stream>
+        void serve(Stream& stream);
+
+        // Echo one request by forwarding its body chunks through `window` as they are decrypted
+        template<class Stream>
+        bool echoStreaming(Stream& stream, int64_t handshakeDuration, log::HandshakePhases const& phases,
+                           log::HandshakeTraffic const& traffic, log::NegotiatedParameters const& parameters,
+                           log::ConnectionContext const& context, boost::beast::error_code& ec);
+
+        template<class Stream>
+        void close(Stream& stream);
 
     public:
-        ServerSession(ServerSession&& other): stream(std::move(other.stream)), buffer(std::move(other.buffer)) {}
-        ServerSession& operator=(ServerSession&& other)
+        ServerSession(ServerSession&& other):
+            pooled(std::move(other.pooled)), stream(std::move(other.stream)), buffer(std::move(other.buffer)),
+            admission(other.admission), admitted(other.admitted), window(std::move(other.window))
         {
-            this->stream = std::move(other.stream);
-            this->buffer = std::move(other.buffer);
-            return *this;
         }
+        ServerSession& operator=(ServerSession&&)      = delete;
         ServerSession(ServerSession const&)            = delete;
         ServerSession& operator=(ServerSession const&) = delete;
 
         // Take ownership of the socket
-        ServerSession(boost::asio::ip::tcp::socket&& socket, boost::asio::ssl::context& ctx):
-            stream(std::move(socket), ctx)
+        ServerSession(boost::asio::ip::tcp::socket&& socket, boost::asio::ssl::context& ctx,
+                      HandshakeAdmission* admission = nullptr, bool admitted = false, uint32_t streamWindow = 0,
+                      bool ktls = false):
+            pooled(SessionPool::getInstance().acquireSSL(ctx.native_handle())),
+            stream(makeStream(std::move(socket), ctx, pooled.get(), ktls)),
+            buffer(SessionPool::getInstance().acquireBuffer()), admission(admission), admitted(admitted),
+            window(streamWindow)
         {
         }
+        ~ServerSession()
+        {
+            SessionPool::getInstance().releaseBuffer(std::move(this->buffer));
+        }
 
         // Start the synchronous operation
         void run();
 
-        // Close the communication
-        void close();
+        // Build the response that echoes the body sent by the client
+        static boost::beast::http::response<boost::beast::http::string_body>
+            makeEchoResponse(boost::beast::http::request<boost::beast::http::string_body>&& req);
+
+        // Build the response header that echoes a request whose body is streamed
+        static boost::beast::http::response<boost::beast::http::buffer_body>
+            makeStreamingEchoResponse(boost::beast::http::request_parser<boost::beast::http::buffer_body> const& parser);
     };
 } // namespace lily::net
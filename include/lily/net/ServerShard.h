@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast.hpp>
+
+#include <lily/net/HandshakeAdmission.h>
+#include <lily/net/ServerOptions.h>
+
+namespace lily::net
+{
+    /**
+     * @brief One independent slice of the sharded server.
+     *
+     * A shard owns its acceptor, `io_context` and TLS context, and runs on a single thread pinned to one core. The
+     * acceptors of all the shards are bound to the same port with `SO_REUSEPORT`, so nothing is shared between the
+     * shards while serving the connections.
+     */
+    class ServerShard
+    {
+    private:
+        uint32_t index;
+        ServerOptions options;
+        std::unique_ptr<boost::beast::net::io_context> ioc;
+        boost::asio::ssl::context ctx;
+        boost::asio::ip::tcp::acceptor acceptor;
+        std::unique_ptr<HandshakeAdmission> admission;
+
+        // Counters used to check the load balance between the shards
+        std::atomic_uint64_t acceptedCount {};
+        std::atomic_uint64_t handshakeCount {};
+
+        boost::asio::awaitable<void> acceptAsync();
+
+    public:
+        ServerShard(uint32_t index, ServerOptions const& options);
+        ServerShard(ServerShard const&)            = delete;
+        ServerShard& operator=(ServerShard const&) = delete;
+
+        boost::asio::ssl::context& getContext()
+        {
+            return this->ctx;
+        }
+        boost::asio::ip::tcp::acceptor& getAcceptor()
+        {
+            return this->acceptor;
+        }
+        HandshakeAdmission const* getAdmission() const
+        {
+            return this->admission.get();
+        }
+        uint32_t getIndex() const
+        {
+            return this->index;
+        }
+        uint64_t getAcceptedCount() const
+        {
+            return this->acceptedCount.load(std::memory_order_relaxed);
+        }
+        uint64_t getHandshakeCount() const
+        {
+            return this->handshakeCount.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Pins the calling thread to the shard core, then accepts and serves the connections.
+         */
+        void run();
+    };
+} // namespace lily::net
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast.hpp>
+#include <mutex>
+#include <openssl/ssl.h>
+#include <vector>
+
+namespace lily::net
+{
+    /**
+     * @brief Recycles the `SSL` objects and grown read buffers of the finished connections.
+     *
+     * Every worker thread keeps its own pool, so acquiring and releasing never take a lock while the worker has
+     * objects left. The objects of a worker exiting are moved to a shared pool, where the thread-per-connection engine
+     * takes them back from the accepting thread.
+     */
+    class SessionPool
+    {
+        friend struct WorkerPool;
+
+    private:
+        uint32_t capacity {};
+
+        // The objects left by the exited workers
+        std::mutex mutex {};
+        std::vector<SSL*> sharedSSLs {};
+        std::vector<boost::beast::flat_buffer> sharedBuffers {};
+
+        std::atomic_uint64_t acquiredCount {};
+        std::atomic_uint64_t sslHitCount {};
+        std::atomic_uint64_t bufferHitCount {};
+
+        SessionPool() = default;
+
+        SessionPool(SessionPool const&)            = delete;
+        SessionPool(SessionPool&&)                 = delete;
+        SessionPool& operator=(SessionPool const&) = delete;
+        SessionPool& operator=(SessionPool&&)      = delete;
+
+        // Move the objects of an exiting worker to the shared pool
+        void adopt(std::vector<SSL*>& ssls, std::vector<boost::beast::flat_buffer>& buffers);
+
+    public:
+        static SessionPool& getInstance();
+
+        // Set the number of objects of each kind kept by every worker, zero disables the pooling. Must be called
+        // before the workers start.
+        void setCapacity(uint32_t capacity)
+        {
+            this->capacity = capacity;
+        }
+        bool isEnabled() const
+        {
+            return this->capacity > 0;
+        }
+
+        /**
+         * @brief Acquires a reset `SSL` object created from `ctx`, or null if the pooling is disabled.
+         *
+         * The returned object carries an extra reference, so it outlives the `ssl::stream` taking ownership of it
+         * and can be handed back with `releaseSSL` once the stream is destroyed.
+         */
+        SSL* acquireSSL(SSL_CTX* ctx);
+        void releaseSSL(SSL* ssl);
+
+        // Acquires an empty read buffer that keeps the capacity it grew to in its previous connection
+        boost::beast::flat_buffer acquireBuffer();
+        void releaseBuffer(boost::beast::flat_buffer&& buffer);
+
+        // Wrap the socket with the pooled `SSL` object if any, or a new one created from `ctx`
+        static boost::asio::ssl::stream<boost::beast::tcp_stream>
+            makeStream(boost::asio::ip::tcp::socket&& socket, boost::asio::ssl::context& ctx, SSL* ssl);
+
+        uint64_t getAcquiredCount() const
+        {
+            return this->acquiredCount.load(std::memory_order_relaxed);
+        }
+        uint64_t getSSLHitCount() const
+        {
+            return this->sslHitCount.load(std::memory_order_relaxed);
+        }
+        uint64_t getBufferHitCount() const
+        {
+            return this->bufferHitCount.load(std::memory_order_relaxed);
+        }
+    };
+
+    /**
+     * @brief Hands the pooled `SSL` object back to the pool when destroyed.
+     */
+    class PooledSSL
+    {
+    private:
+        SSL* ssl;
+
+    public:
+        explicit PooledSSL(SSL* ssl): ssl(ssl) {}
+        PooledSSL(PooledSSL&& other): ssl(std::exchange(other.ssl, nullptr)) {}
+        PooledSSL& operator=(PooledSSL&& other)
+        {
+            std::swap(this->ssl, other.ssl);
+            return *this;
+        }
+        PooledSSL(PooledSSL const&)            = delete;
+        PooledSSL& operator=(PooledSSL const&) = delete;
+        ~PooledSSL()
+        {
+            if (this->ssl)
+                SessionPool::getInstance().releaseSSL(this->ssl);
+        }
+
+        SSL* get() const
+        {
+            return this->ssl;
+        }
+    };
+} // namespace lily::net
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <lily/net/ClientOptions.h>
+#include <lily/net/ClientRunner.h>
+#include <lily/net/SweepOptions.h>
+
+namespace lily::net
+{
+    /**
+     * @brief Measures every combination of TLS group, signature algorithm, payload size and concurrency.
+     *
+     * Each cell gets its own `ClientRunner`, warmed up then measured over a fixed window against the same running
+     * server, so the KEMs and signatures are compared under the same conditions. The cells are saved in one CSV and
+     * one JSON table with their TPS, their latency and handshake percentiles, and the bytes of their handshakes.
+     */
+    class Sweep
+    {
+    private:
+        struct Cell
+        {
+            ClientOptions options;
+            ClientRunner::Measurement measurement {};
+
+            // Whether the runner of the cell could be created
+            bool measured {};
+        };
+
+        ClientOptions clientOptions;
+        SweepOptions options;
+
+        // Replace `all` by every name of the supported list
+        static std::vector<std::string> expand(std::vector<std::string> const& names, std::string_view supported);
+
+        // Save the cells as the CSV and the JSON tables
+        static void writeTables(std::vector<Cell> const& cells);
+
+    public:
+        /**
+         * @brief Constructs a new `Sweep` instance.
+         *
+         * @param clientOptions The server and the engine configuration, the fields varied by the cells are ignored.
+         * @param options The values combined into the cells and their measurement windows.
+         */
+        Sweep(ClientOptions const& clientOptions, SweepOptions const& options);
+
+        /**
+         * @brief Measures every cell in turn, then saves the tables.
+         */
+        void run();
+    };
+} // namespace lily::net
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lily::net
+{
+    /**
+     * @brief The configuration of `sweep`, on top of the `ClientOptions` shared by every cell.
+     */
+    struct SweepOptions
+    {
+        // The TLS groups of the cells, `all` stands for every one of `SUPPORTED_PQC_GROUPS_LIST`
+        std::vector<std::string> tlsGroups {};
+
+        // The signature algorithm offered alone by the cells, `all` stands for every one of `SUPPORTED_SIGALGS_LIST`.
+        // Empty offers every supported one on each cell.
+        std::vector<std::string> sigalgs {};
+
+        // The sizes of the dummy body of the cells
+        std::vector<uint32_t> dataLengths {};
+
+        // The numbers of concurrent users of the cells, in closed loop
+        std::vector<uint32_t> concurrentUsers {};
+
+        // The time given to the server to reach its steady state on each cell, not measured, in seconds
+        uint32_t warmUpSeconds {5};
+
+        // The time measured on each cell once warmed up, in seconds
+        uint32_t windowSeconds {10};
+    };
+} // namespace lily::net
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <openssl/ssl.h>
+#include <random>
+
+#include <lily/log/LatencyHistogram.h>
+
+namespace lily::net
+{
+    /**
+     * @brief The state kept by one simulated client user between its requests.
+     */
+    struct VirtualUser
+    {
+        // The last resumable TLS session received from the server
+        std::unique_ptr<SSL_SESSION, decltype(&SSL_SESSION_free)> session {nullptr, SSL_SESSION_free};
+
+        // When the current connection was due to start, the latency of its first request is measured from there
+        std::chrono::high_resolution_clock::time_point scheduledStart {};
+
+        // The number of requests answered by the server, over every connection of this user
+        uint64_t completedRequests {};
+
+        // Draws the size and the slice of the body of each request
+        std::mt19937_64 generator {std::random_device {}()};
+
+        // Where the latencies of each answered request are recorded, if anywhere. Shared by the users of a thread.
+        log::RequestHistograms* histograms {};
+
+        // Counted as soon as each request is answered, if anywhere, so a connection which is never closed still shows
+        // its requests. Shared by every user of the run.
+        std::atomic_int64_t* successfulRequests {};
+    };
+} // namespace lily::net
@@ -0,0 +1,284 @@
+#include <algorithm>
+#include <fmt/chrono.h>
+#include <fmt/color.h>
+#include <fmt/core.h>
+#include <fstream>
+#include <latch>
+#include <openssl/evp.h>
+#include <spdlog/spdlog.h>
+#include <thread>
+
+#include <lily/core/Constants.h>
+#include <lily/crypto/PrimitiveBench.h>
+#include <lily/log/PrimitiveLog.h>
+
+using namespace lily::core;
+
+namespace lily::crypto
+{
+    // Fetch every primitive from the OQS provider, even when the default provider implements the same algorithm
+    static constexpr char const* PROVIDER_QUERY {"provider=oqsprovider"};
+
+    // About the size of the content signed by a TLS 1.3 CertificateVerify
+    static constexpr std::array<unsigned char, 130> MESSAGE {};
+
+    PrimitiveBench::PrimitiveBench(BenchOptions const& options): options(options)
+    {
+    }
+
+    // Replace `all` by every name of the supported list, the classical signature schemes (eg, RSA+SHA256) aren't
+    // key types of the provider
+    static std::vector<std::string> expand(std::vector<std::string> const& names, std::string_view supported)
+    {
+        std::vector<std::string> expanded {};
+        for (auto const& name: names)
+        {
+            if (name != "all")
+            {
+                expanded.push_back(name);
+                continue;
+            }
+            for (std::size_t begin {}; begin < supported.size();)
+            {
+                auto end {std::min(supported.find(':', begin), supported.size())};
+                auto supportedName {supported.substr(begin, end - begin)};
+                if (supportedName.find('+') == std::string_view::npos)
+                    expanded.emplace_back(supportedName);
+                begin = end + 1;
+            }
+        }
+        return expanded;
+    }
+
+    // Add the time elapsed since `begin` to the histogram, in ns
+    static void recordSince(log::LatencyHistogram& histogram, std::chrono::steady_clock::time_point begin)
+    {
+        histogram.record(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count());
+    }
+
+    static std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> generateKey(std::string const& algorithm)
+    {
+        std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> key {nullptr, EVP_PKEY_free};
+        std::unique_ptr<EVP_PKEY_CTX, decltype(&EVP_PKEY_CTX_free)> ctx {
+            EVP_PKEY_CTX_new_from_name(nullptr, algorithm.c_str(), PROVIDER_QUERY), EVP_PKEY_CTX_free};
+        EVP_PKEY* keyPtr {};
+        if (ctx and EVP_PKEY_keygen_init(ctx.get()) == 1 and EVP_PKEY_generate(ctx.get(), &keyPtr) == 1)
+            key.reset(keyPtr);
+        return key;
+    }
+
+    bool PrimitiveBench::runCycles(BenchKind kind, std::string const& algorithm,
+                                   std::chrono::steady_clock::time_point deadline, Durations& durations)
+    {
+        // The buffers are kept across the cycles, so the primitives are measured without their allocation
+        std::vector<unsigned char> ciphertext {};
+        std::vector<unsigned char> secret {};
+        std::vector<unsigned char> signature {};
+
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            // Generate the key pair of the decapsulating or signing side
+            auto begin {std::chrono::steady_clock::now()};
+            auto key {generateKey(algorithm)};
+            if (!key)
+                return false;
+            recordSince(durations[0], begin);
+
+            if (kind == BenchKind::LILY_BENCH_KEM)
+            {
+                // Encapsulate a secret to the public key, the contexts are part of the primitive as in a handshake
+                begin = std::chrono::steady_clock::now();
+                std::unique_ptr<EVP_PKEY_CTX, decltype(&EVP_PKEY_CTX_free)> encapsCtx {
+                    EVP_PKEY_CTX_new_from_pkey(nullptr, key.get(), PROVIDER_QUERY), EVP_PKEY_CTX_free};
+                std::size_t ciphertextLength {};
+                std::size_t secretLength {};
+                if (!encapsCtx or EVP_PKEY_encapsulate_init(encapsCtx.get(), nullptr) != 1 or
+                    EVP_PKEY_encapsulate(encapsCtx.get(), nullptr, &ciphertextLength, nullptr, &secretLength) != 1)
+                    return false;
+                ciphertext.resize(ciphertextLength);
+                secret.resize(secretLength);
+                if (EVP_PKEY_encapsulate(encapsCtx.get(), ciphertext.data(), &ciphertextLength, secret.data(),
+                                         &secretLength) != 1)
+                    return false;
+                recordSince(durations[1], begin);
+
+                // Decapsulate it with the private key
+                begin = std::chrono::steady_clock::now();
+                std::unique_ptr<EVP_PKEY_CTX, decltype(&EVP_PKEY_CTX_free)> decapsCtx {
+                    EVP_PKEY_CTX_new_from_pkey(nullptr, key.get(), PROVIDER_QUERY), EVP_PKEY_CTX_free};
+                if (!decapsCtx or EVP_PKEY_decapsulate_init(decapsCtx.get(), nullptr) != 1 or
+                    EVP_PKEY_decapsulate(decapsCtx.get(), secret.data(), &secretLength, ciphertext.data(),
+                                         ciphertextLength) != 1)
+                    return false;
+                recordSince(durations[2], begin);
+                continue;
+            }
+
+            // Sign the message with the private key, without a digest as in a TLS 1.3 handshake
+            begin = std::chrono::steady_clock::now();
+            std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> signCtx {EVP_MD_CTX_new(), EVP_MD_CTX_free};
+            std::size_t signatureLength {};
+            if (!signCtx or
+                EVP_DigestSignInit_ex(signCtx.get(), nullptr, nullptr, nullptr, PROVIDER_QUERY, key.get(), nullptr) !=
+                    1 or
+                EVP_DigestSign(signCtx.get(), nullptr, &signatureLength, MESSAGE.data(), MESSAGE.size()) != 1)
+                return false;
+            signature.resize(signatureLength);
+            if (EVP_DigestSign(signCtx.get(), signature.data(), &signatureLength, MESSAGE.data(), MESSAGE.size()) != 1)
+                return false;
+            recordSince(durations[1], begin);
+
+            // Verify the signature with the public key
+            begin = std::chrono::steady_clock::now();
+            std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> verifyCtx {EVP_MD_CTX_new(), EVP_MD_CTX_free};
+            if (!verifyCtx or
+                EVP_DigestVerifyInit_ex(verifyCtx.get(), nullptr, nullptr, nullptr, PROVIDER_QUERY, key.get(),
+                                        nullptr) != 1 or
+                EVP_DigestVerify(verifyCtx.get(), signature.data(), signatureLength, MESSAGE.data(), MESSAGE.size()) !=
+                    1)
+                return false;
+            recordSince(durations[2], begin);
+        }
+        return true;
+    }
+
+    PrimitiveBench::Run PrimitiveBench::measure(std::string const& algorithm, uint32_t threads) const
+    {
+        Run run {algorithm, threads};
+
+        // Each thread records into its own histograms, merged once they are all joined
+        std::vector<std::unique_ptr<Durations>> threadDurations {};
+        for (uint32_t i {}; i < threads; ++i)
+            threadDurations.push_back(std::make_unique<Durations>());
+        std::vector<char> succeeded(threads);
+
+        // Start the threads together, so the deadline gives them the same time
+        std::latch ready {threads + 1};
+        std::chrono::steady_clock::time_point begin {};
+        std::chrono::steady_clock::time_point deadline {};
+        {
+            std::vector<std::jthread> workers {};
+            for (uint32_t i {}; i < threads; ++i)
+                workers.emplace_back(
+                    [&, i]
+                    {
+                        ready.arrive_and_wait();
+                        succeeded[i] = runCycles(this->options.kind, algorithm, deadline, *threadDurations[i]);
+                    });
+            begin    = std::chrono::steady_clock::now();
+            deadline = begin + std::chrono::seconds {this->options.durationSeconds};
+            ready.arrive_and_wait();
+        }
+
+        // The last cycle of each thread ends after the deadline, so the run lasts until the last thread is joined
+        run.seconds  = std::chrono::duration<double> {std::chrono::steady_clock::now() - begin}.count();
+        run.measured = std::ranges::all_of(succeeded, [](char result) { return result != 0; });
+        for (auto const& durations: threadDurations)
+            for (std::size_t operation {}; operation < OPERATION_COUNT; ++operation)
+                (*run.durations)[operation].add((*durations)[operation]);
+        return run;
+    }
+
+    std::array<std::string_view, PrimitiveBench::OPERATION_COUNT> PrimitiveBench::getOperationNames() const
+    {
+        using log::PrimitiveOperation;
+        if (this->options.kind == BenchKind::LILY_BENCH_KEM)
+            return {log::PrimitiveLog::getOperationName(PrimitiveOperation::LILY_PRIMITIVE_KEYGEN),
+                    log::PrimitiveLog::getOperationName(PrimitiveOperation::LILY_PRIMITIVE_ENCAPS),
+                    log::PrimitiveLog::getOperationName(PrimitiveOperation::LILY_PRIMITIVE_DECAPS)};
+        return {log::PrimitiveLog::getOperationName(PrimitiveOperation::LILY_PRIMITIVE_KEYGEN),
+                log::PrimitiveLog::getOperationName(PrimitiveOperation::LILY_PRIMITIVE_SIGN),
+                log::PrimitiveLog::getOperationName(PrimitiveOperation::LILY_PRIMITIVE_VERIFY)};
+    }
+
+    void PrimitiveBench::run()
+    {
+        auto algorithms {this->options.kind == BenchKind::LILY_BENCH_KEM
+                             ? expand(this->options.algorithms, constants::SUPPORTED_PQC_GROUPS_LIST)
+                             : expand(this->options.algorithms, constants::SUPPORTED_SIGALGS_LIST)};
+
+        // One thread comes first, as the reference of the scaling efficiency
+        std::vector<uint32_t> threadCounts {1};
+        for (auto threads: this->options.threads)
+            if (std::ranges::find(threadCounts, threads) == threadCounts.end())
+                threadCounts.push_back(threads);
+
+        auto operationNames {this->getOperationNames()};
+        std::vector<Run> runs {};
+        for (std::size_t i {}; i < algorithms.size(); ++i)
+        {
+            for (auto threads: threadCounts)
+            {
+                fmt::print("[-] Algorithm {}/{} | {} | Threads: {}\r\n", i + 1, algorithms.size(), algorithms[i],
+                           threads);
+
+                // An algorithm unknown to the provider only fails its own runs
+                auto& run {runs.emplace_back(this->measure(algorithms[i], threads))};
+                if (!run.measured)
+                {
+                    spdlog::error("Lily-PQC bench of {} failed! Why: the provider couldn't run its primitives",
+                                  algorithms[i]);
+                    break;
+                }
+
+                for (std::size_t operation {}; operation < OPERATION_COUNT; ++operation)
+                {
+                    auto const& histogram {(*run.durations)[operation]};
+                    fmt::print("[-] {} | {:.2f} op/s | p50: {} ns | p99: {} ns\r\n", operationNames[operation],
+                               histogram.getCount() / run.seconds, histogram.getPercentile(50.0),
+                               histogram.getPercentile(99.0));
+                }
+            }
+        }
+
+        this->writeTable(runs);
+    }
+
+    void PrimitiveBench::writeTable(std::vector<Run> const& runs) const
+    {
+        auto fileName {this->options.outputPath};
+        if (fileName.empty())
+            fileName = fmt::format("{:%F_%T}_bench_{}.json", fmt::localtime(std::time(nullptr)),
+                                   this->options.kind == BenchKind::LILY_BENCH_KEM ? "kem" : "sig");
+        std::ofstream jsonStream {fileName};
+        if (!jsonStream.is_open())
+        {
+            spdlog::error("Failed to create primitive bench table");
+            return;
+        }
+
+        auto operationNames {this->getOperationNames()};
+        jsonStream << "[\n";
+        for (std::size_t i {}; i < runs.size(); ++i)
+        {
+            auto const& run {runs[i]};
+
+            // The single thread run of the algorithm, always measured first
+            auto reference {std::ranges::find_if(runs, [&](Run const& other)
+                                                 { return other.algorithm == run.algorithm and other.threads == 1; })};
+
+            std::string operations {};
+            for (std::size_t operation {}; operation < OPERATION_COUNT; ++operation)
+            {
+                auto const& histogram {(*run.durations)[operation]};
+                auto opsPerSecond {histogram.getCount() / run.seconds};
+                auto referenceOpsPerSecond {(*reference->durations)[operation].getCount() / reference->seconds};
+                auto efficiency {referenceOpsPerSecond > 0 ? opsPerSecond / (referenceOpsPerSecond * run.threads) : 0};
+                operations += fmt::format(
+                    R"("{}": {{"count": {}, "ops_per_s": {:.2f}, "scaling_efficiency": {:.4f}, )"
+                    R"("ns_per_op": {{"mean": {:.0f}, "p50": {}, "p90": {}, "p99": {}, "p999": {}, "max": {}}}}}{})",
+                    operationNames[operation], histogram.getCount(), opsPerSecond, efficiency, histogram.getMean(),
+                    histogram.getPercentile(50.0), histogram.getPercentile(90.0), histogram.getPercentile(99.0),
+                    histogram.getPercentile(99.9), histogram.getMax(), operation + 1 < OPERATION_COUNT ? ", " : "");
+            }
+            jsonStream << fmt::format(
+                R"(  {{"algorithm": "{}", "threads": {}, "measured": {}, "seconds": {:.3f}, "operations": {{{}}}}}{})"
+                "\n",
+                run.algorithm, run.threads, run.measured, run.seconds, operations, i + 1 < runs.size() ? "," : "");
+        }
+        jsonStream << "]\n";
+        fmt::print(fmt::fg(fmt::color::green), "[v] Bench of {} runs saved to `{}`\r\n", runs.size(),
+                   fileName.string());
+    }
+} // namespace lily::crypto
@@ -0,0 +1,35 @@
+#include <cstdint>
+
+// The timing hook added to liboqs by `external/liboqs-measuretime.patch`
+#include <oqs/measure.h>
+
+#include <lily/crypto/PrimitiveHook.h>
+#include <lily/log/ConnectionContext.h>
+#include <lily/log/PrimitiveLog.h>
+
+namespace lily::crypto
+{
+    // `log::PrimitiveOperation` follows the order of `OQS_MEASURE_OPERATION`
+    static void recordPrimitive(OQS_MEASURE_OPERATION operation, char const* methodName, uint64_t durationNs)
+    {
+        // Add the duration to the handshake running on this thread, if any
+        auto context {log::ConnectionContext::current};
+        if (context)
+        {
+            if (operation == OQS_MEASURE_SIG_SIGN or operation == OQS_MEASURE_SIG_VERIFY)
+                context->primitives.signatureNs += durationNs;
+            else
+                context->primitives.kemNs += durationNs;
+        }
+
+        log::PrimitiveLog::getInstance().write(context ? context->id : 0,
+                                               static_cast<log::PrimitiveOperation>(operation), methodName, durationNs);
+    }
+
+    void installPrimitiveHook()
+    {
+        // Build the log and start its writer now, rather than within the first timed primitive
+        log::PrimitiveLog::getInstance();
+        OQS_MEASURE_set_hook(recordPrimitive);
+    }
+} // namespace lily::crypto
@@ -1,4 +1,6 @@
+#include <cstddef>
 #include <fmt/chrono.h>
+#include <fmt/format.h>
 #include <spdlog/spdlog.h>
 
 #include <lily/log/ClientLog.h>
@@ -6,20 +8,65 @@
 namespace lily::log
 {
     static auto BOOTSTRAP_TIME {std::time(nullptr)};
+    static std::string fileTag {};
+    static LogFormat logFormat {LogFormat::LILY_LOG_FORMAT_CSV};
+    static std::atomic<LogOverflow> overflow {LogOverflow::LILY_LOG_OVERFLOW_BLOCK};
 
-    ClientLog::ClientLog()
+    std::array<LogField, 28> const ClientLog::FIELDS {{
+        {"hs_duration_us", LogFieldType::LILY_FIELD_INT64, offsetof(Record, hsDurationUs)},
+        {"hs_client_hello_us", LogFieldType::LILY_FIELD_INT64, offsetof(Record, phases.clientHelloUs)},
+        {"hs_server_hello_us", LogFieldType::LILY_FIELD_INT64, offsetof(Record, phases.serverHelloUs)},
+        {"hs_encrypted_extensions_us", LogFieldType::LILY_FIELD_INT64, offsetof(Record, phases.encryptedExtensionsUs)},
+        {"hs_certificate_us", LogFieldType::LILY_FIELD_INT64, offsetof(Record, phases.certificateUs)},
+        {"hs_certificate_verify_us", LogFieldType::LILY_FIELD_INT64, offsetof(Record, phases.certificateVerifyUs)},
+        {"hs_server_finished_us", LogFieldType::LILY_FIELD_INT64, offsetof(Record, phases.serverFinishedUs)},
+        {"hs_client_finished_us", LogFieldType::LILY_FIELD_INT64, offsetof(Record, phases.clientFinishedUs)},
+        {"write_size", LogFieldType::LILY_FIELD_UINT64, offsetof(Record, writeSize)},
+        {"write_duration_us", LogFieldType::LILY_FIELD_INT64, offsetof(Record, writeDurationUs)},
+        {"recv_size", LogFieldType::LILY_FIELD_UINT64, offsetof(Record, recvSize)},
+        {"recv_duration_us", LogFieldType::LILY_FIELD_INT64, offsetof(Record, recvDurationUs)},
+        {"resumed", LogFieldType::LILY_FIELD_BOOL, offsetof(Record, resumed)},
+        {"ktls_tx", LogFieldType::LILY_FIELD_BOOL, offsetof(Record, ktlsSend)},
+        {"ktls_rx", LogFieldType::LILY_FIELD_BOOL, offsetof(Record, ktlsRecv)},
+        {"request_index", LogFieldType::LILY_FIELD_UINT64, offsetof(Record, requestIndex)},
+        {"latency_us", LogFieldType::LILY_FIELD_INT64, offsetof(Record, latencyUs)},
+        {"payload_size", LogFieldType::LILY_FIELD_UINT32, offsetof(Record, payloadSize)},
+        {"hs_bytes_sent", LogFieldType::LILY_FIELD_UINT64, offsetof(Record, traffic.bytesSent)},
+        {"hs_bytes_received", LogFieldType::LILY_FIELD_UINT64, offsetof(Record, traffic.bytesReceived)},
+        {"hs_records_sent", LogFieldType::LILY_FIELD_UINT32, offsetof(Record, traffic.recordsSent)},
+        {"hs_records_received", LogFieldType::LILY_FIELD_UINT32, offsetof(Record, traffic.recordsReceived)},
+        {"group", LogFieldType::LILY_FIELD_NAME, offsetof(Record, parameters.group)},
+        {"sigalg", LogFieldType::LILY_FIELD_NAME, offsetof(Record, parameters.sigalg)},
+        {"cipher", LogFieldType::LILY_FIELD_NAME, offsetof(Record, parameters.cipher)},
+        {"connection_id", LogFieldType::LILY_FIELD_UINT64, offsetof(Record, connectionId)},
+        {"hs_kem_ns", LogFieldType::LILY_FIELD_UINT64, offsetof(Record, primitives.kemNs)},
+        {"hs_signature_ns", LogFieldType::LILY_FIELD_UINT64, offsetof(Record, primitives.signatureNs)},
+    }};
+
+    ClientLog::ClientLog():
+        writer {LogFile::create(getFilePrefix(), logFormat, FIELDS),
+                logFormat == LogFormat::LILY_LOG_FORMAT_BINARY ? formatBinary : formatCsv, "client"}
+    {
+    }
+
+    std::string ClientLog::getFilePrefix()
+    {
+        return fmt::format("{:%F_%T}_log_client{}", fmt::localtime(BOOTSTRAP_TIME), fileTag);
+    }
+
+    void ClientLog::setFileTag(std::string const& tag)
+    {
+        fileTag = tag;
+    }
+
+    void ClientLog::setFormat(LogFormat format)
     {
-        //
-        this->stream.open(fmt::format("{:%F_%T}_log_client.csv", fmt::localtime(BOOTSTRAP_TIME)));
-        if (!this->stream.is_open())
-        {
-            spdlog::error("Failed to create client record log");
-            std::exit(EXIT_FAILURE);
-        }
-        static constexpr std::string_view HEADER {
-            "hs_duration_us;write_size;write_duration_us;recv_size;recv_duration_us\r\n"};
-        this->stream.write(HEADER.data(), HEADER.size());
-        this->stream.flush();
+        logFormat = format;
+    }
+
+    void ClientLog::setOverflow(LogOverflow policy)
+    {
+        overflow.store(policy, std::memory_order_relaxed);
     }
 
     ClientLog& ClientLog::getInstance()
@@ -28,13 +75,36 @@ namespace lily::log
         return instance;
     }
 
-    void ClientLog::write(int64_t hsDurationUs, uint64_t writeSize, int64_t writeDurationUs, uint64_t recvSize,
-                          int64_t recvDurationUs)
+    void ClientLog::formatCsv(Record const& record, std::string& batch)
+    {
+        fmt::format_to(std::back_inserter(batch),
+                       "{};{};{};{};{};{};{};{};{};{};{};{};{:d};{:d};{:d};{};{};{};{};{};{};{};{};{};{};{};{};"
+                       "{}\r\n",
+                       record.hsDurationUs, record.phases.clientHelloUs, record.phases.serverHelloUs,
+                       record.phases.encryptedExtensionsUs, record.phases.certificateUs,
+                       record.phases.certificateVerifyUs, record.phases.serverFinishedUs,
+                       record.phases.clientFinishedUs, record.writeSize, record.writeDurationUs, record.recvSize,
+                       record.recvDurationUs, record.resumed, record.ktlsSend, record.ktlsRecv, record.requestIndex,
+                       record.latencyUs, record.payloadSize, record.traffic.bytesSent, record.traffic.bytesReceived,
+                       record.traffic.recordsSent, record.traffic.recordsReceived, getLogName(record.parameters.group),
+                       getLogName(record.parameters.sigalg), getLogName(record.parameters.cipher), record.connectionId,
+                       record.primitives.kemNs, record.primitives.signatureNs);
+    }
+
+    void ClientLog::formatBinary(Record const& record, std::string& batch)
+    {
+        packRecord(record, FIELDS, batch);
+    }
+
+    void ClientLog::write(int64_t hsDurationUs, HandshakePhases const& phases, HandshakeTraffic const& traffic,
+                          uint64_t writeSize, int64_t writeDurationUs, uint64_t recvSize, int64_t recvDurationUs,
+                          bool resumed, bool ktlsSend, bool ktlsRecv, uint64_t requestIndex, int64_t latencyUs,
+                          uint32_t payloadSize, NegotiatedParameters const& parameters,
+                          uint64_t connectionId, PrimitiveTimes const& primitives)
     {
-        auto log {
-            fmt::format("{};{};{};{};{}\r\n", hsDurationUs, writeSize, writeDurationUs, recvSize, recvDurationUs)};
-        std::lock_guard lock {this->mtx};
-        this->stream.write(log.c_str(), log.size());
-        this->stream.flush();
+        this->writer.write({hsDurationUs, phases, traffic, writeSize, writeDurationUs, recvSize, recvDurationUs,
+                            requestIndex, latencyUs, payloadSize, resumed, ktlsSend, ktlsRecv, parameters, connectionId,
+                            primitives},
+                           overflow.load(std::memory_order_relaxed));
     }
 } // namespace lily::log
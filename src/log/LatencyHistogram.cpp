@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#include <lily/log/LatencyHistogram.h>
+
+namespace lily::log
+{
+    uint32_t LatencyHistogram::getIndex(uint64_t value)
+    {
+        if (value < SUB_BUCKET_COUNT)
+            return static_cast<uint32_t>(value);
+
+        // Keep the 6 most significant bits, the leading one selecting the upper half of the sub-buckets
+        auto exponent {std::min<uint32_t>(std::bit_width(value) - std::bit_width(SUB_BUCKET_COUNT - 1), MAX_EXPONENT)};
+        auto subBucket {std::min<uint64_t>(value >> exponent, SUB_BUCKET_COUNT - 1)};
+        return SUB_BUCKET_COUNT + (exponent - 1) * SUB_BUCKET_HALF_COUNT +
+               static_cast<uint32_t>(subBucket - SUB_BUCKET_HALF_COUNT);
+    }
+
+    uint64_t LatencyHistogram::getHighestEquivalent(uint32_t index)
+    {
+        if (index < SUB_BUCKET_COUNT)
+            return index;
+
+        auto exponent {(index - SUB_BUCKET_COUNT) / SUB_BUCKET_HALF_COUNT + 1};
+        auto subBucket {uint64_t {(index - SUB_BUCKET_COUNT) % SUB_BUCKET_HALF_COUNT + SUB_BUCKET_HALF_COUNT}};
+        return ((subBucket + 1) << exponent) - 1;
+    }
+
+    void LatencyHistogram::record(int64_t value)
+    {
+        auto unsignedValue {static_cast<uint64_t>(std::max<int64_t>(value, 0))};
+        this->buckets[getIndex(unsignedValue)].fetch_add(1, std::memory_order_relaxed);
+        this->totalCount.fetch_add(1, std::memory_order_relaxed);
+        this->totalSum.fetch_add(unsignedValue, std::memory_order_relaxed);
+
+        auto currentMax {this->maxValue.load(std::memory_order_relaxed)};
+        while (unsignedValue > currentMax and
+               !this->maxValue.compare_exchange_weak(currentMax, unsignedValue, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void LatencyHistogram::add(LatencyHistogram const& other)
+    {
+        for (std::size_t i {}; i < BUCKET_COUNT; ++i)
+            if (auto count {other.buckets[i].load(std::memory_order_relaxed)}; count != 0)
+                this->buckets[i].fetch_add(count, std::memory_order_relaxed);
+        this->totalCount.fetch_add(other.totalCount.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        this->totalSum.fetch_add(other.totalSum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+        auto otherMax {other.maxValue.load(std::memory_order_relaxed)};
+        auto currentMax {this->maxValue.load(std::memory_order_relaxed)};
+        while (otherMax > currentMax and
+               !this->maxValue.compare_exchange_weak(currentMax, otherMax, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void LatencyHistogram::drainInto(LatencyHistogram& target)
+    {
+        for (std::size_t i {}; i < BUCKET_COUNT; ++i)
+            if (auto count {this->buckets[i].exchange(0, std::memory_order_relaxed)}; count != 0)
+                target.buckets[i].fetch_add(count, std::memory_order_relaxed);
+        target.totalCount.fetch_add(this->totalCount.exchange(0, std::memory_order_relaxed),
+                                    std::memory_order_relaxed);
+        target.totalSum.fetch_add(this->totalSum.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+
+        auto drainedMax {this->maxValue.exchange(0, std::memory_order_relaxed)};
+        auto currentMax {target.maxValue.load(std::memory_order_relaxed)};
+        while (drainedMax > currentMax and
+               !target.maxValue.compare_exchange_weak(currentMax, drainedMax, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void LatencyHistogram::reset()
+    {
+        for (auto& bucket: this->buckets)
+            bucket.store(0, std::memory_order_relaxed);
+        this->totalCount.store(0, std::memory_order_relaxed);
+        this->totalSum.store(0, std::memory_order_relaxed);
+        this->maxValue.store(0, std::memory_order_relaxed);
+    }
+
+    void LatencyHistogram::serialize(std::span<uint64_t, SERIALIZED_SIZE> target) const
+    {
+        for (std::size_t i {}; i < BUCKET_COUNT; ++i)
+            target[i] = this->buckets[i].load(std::memory_order_relaxed);
+        target[BUCKET_COUNT]     = this->totalSum.load(std::memory_order_relaxed);
+        target[BUCKET_COUNT + 1] = this->maxValue.load(std::memory_order_relaxed);
+    }
+
+    void LatencyHistogram::addSerialized(std::span<uint64_t const, SERIALIZED_SIZE> source)
+    {
+        uint64_t count {};
+        for (std::size_t i {}; i < BUCKET_COUNT; ++i)
+        {
+            this->buckets[i].fetch_add(source[i], std::memory_order_relaxed);
+            count += source[i];
+        }
+        this->totalCount.fetch_add(count, std::memory_order_relaxed);
+        this->totalSum.fetch_add(source[BUCKET_COUNT], std::memory_order_relaxed);
+
+        auto currentMax {this->maxValue.load(std::memory_order_relaxed)};
+        while (source[BUCKET_COUNT + 1] > currentMax and
+               !this->maxValue.compare_exchange_weak(currentMax, source[BUCKET_COUNT + 1], std::memory_order_relaxed))
+        {
+        }
+    }
+
+    double LatencyHistogram::getMean() const
+    {
+        auto count {this->getCount()};
+        return count == 0 ? 0.0 : static_cast<double>(this->totalSum.load(std::memory_order_relaxed)) / count;
+    }
+
+    uint64_t LatencyHistogram::getPercentile(double percentile) const
+    {
+        // Sum the buckets rather than trusting `totalCount`, which may be ahead of them while recording
+        uint64_t count {};
+        for (auto const& bucket: this->buckets)
+            count += bucket.load(std::memory_order_relaxed);
+        if (count == 0)
+            return 0;
+
+        auto rank {std::max<uint64_t>(static_cast<uint64_t>(std::ceil(percentile / 100.0 * count)), 1)};
+        uint64_t seen {};
+        for (uint32_t i {}; i < BUCKET_COUNT; ++i)
+        {
+            seen += this->buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank)
+                return std::min(getHighestEquivalent(i), this->getMax());
+        }
+        return this->getMax();
+    }
+
+    uint64_t LatencyHistogram::getCountAtOrBelow(uint64_t value) const
+    {
+        uint64_t count {};
+        for (uint32_t i {}; i < BUCKET_COUNT and getHighestEquivalent(i) <= value; ++i)
+            count += this->buckets[i].load(std::memory_order_relaxed);
+        return count;
+    }
+
+    double GroupTotals::getMean(Total total) const
+    {
+        auto handshakes {this->totals[LILY_GROUP_HANDSHAKES].load(std::memory_order_relaxed)};
+        return handshakes == 0 ? 0.0
+                               : static_cast<double>(this->totals[total].load(std::memory_order_relaxed)) / handshakes;
+    }
+
+    void RequestHistograms::add(RequestHistograms const& other)
+    {
+        this->handshake.add(other.handshake);
+        this->write.add(other.write);
+        this->read.add(other.read);
+        this->total.add(other.total);
+        this->recordHandshakeBytes(other.handshakeBytesSent.load(std::memory_order_relaxed),
+                                   other.handshakeBytesReceived.load(std::memory_order_relaxed));
+        for (std::size_t group {}; group < MAX_GROUP_COUNT; ++group)
+            for (std::size_t i {}; i < GroupTotals::LILY_GROUP_TOTAL_COUNT; ++i)
+                this->groups[group].totals[i].fetch_add(other.groups[group].totals[i].load(std::memory_order_relaxed),
+                                                        std::memory_order_relaxed);
+    }
+
+    void RequestHistograms::recordHandshakeBytes(uint64_t sent, uint64_t received)
+    {
+        this->handshakeBytesSent.fetch_add(sent, std::memory_order_relaxed);
+        this->handshakeBytesReceived.fetch_add(received, std::memory_order_relaxed);
+    }
+
+    void RequestHistograms::recordGroup(std::size_t group, int64_t handshakeUs, HandshakeTraffic const& traffic)
+    {
+        if (group >= MAX_GROUP_COUNT)
+            return;
+        auto& totals {this->groups[group].totals};
+        totals[GroupTotals::LILY_GROUP_HANDSHAKES].fetch_add(1, std::memory_order_relaxed);
+        totals[GroupTotals::LILY_GROUP_HANDSHAKE_US].fetch_add(std::max<int64_t>(handshakeUs, 0),
+                                                               std::memory_order_relaxed);
+        totals[GroupTotals::LILY_GROUP_BYTES_SENT].fetch_add(traffic.bytesSent, std::memory_order_relaxed);
+        totals[GroupTotals::LILY_GROUP_BYTES_RECEIVED].fetch_add(traffic.bytesReceived, std::memory_order_relaxed);
+        totals[GroupTotals::LILY_GROUP_RECORDS_SENT].fetch_add(traffic.recordsSent, std::memory_order_relaxed);
+        totals[GroupTotals::LILY_GROUP_RECORDS_RECEIVED].fetch_add(traffic.recordsReceived,
+                                                                   std::memory_order_relaxed);
+    }
+
+    void RequestHistograms::drainInto(RequestHistograms& target)
+    {
+        this->handshake.drainInto(target.handshake);
+        this->write.drainInto(target.write);
+        this->read.drainInto(target.read);
+        this->total.drainInto(target.total);
+        target.recordHandshakeBytes(this->handshakeBytesSent.exchange(0, std::memory_order_relaxed),
+                                    this->handshakeBytesReceived.exchange(0, std::memory_order_relaxed));
+        for (std::size_t group {}; group < MAX_GROUP_COUNT; ++group)
+            for (std::size_t i {}; i < GroupTotals::LILY_GROUP_TOTAL_COUNT; ++i)
+                target.groups[group].totals[i].fetch_add(
+                    this->groups[group].totals[i].exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    void RequestHistograms::serialize(std::span<uint64_t, SERIALIZED_SIZE> target) const
+    {
+        constexpr auto SIZE {LatencyHistogram::SERIALIZED_SIZE};
+        this->handshake.serialize(target.subspan<0, SIZE>());
+        this->write.serialize(target.subspan<SIZE, SIZE>());
+        this->read.serialize(target.subspan<SIZE * 2, SIZE>());
+        this->total.serialize(target.subspan<SIZE * 3, SIZE>());
+        target[SIZE * 4]     = this->handshakeBytesSent.load(std::memory_order_relaxed);
+        target[SIZE * 4 + 1] = this->handshakeBytesReceived.load(std::memory_order_relaxed);
+        for (std::size_t group {}; group < MAX_GROUP_COUNT; ++group)
+            for (std::size_t i {}; i < GroupTotals::LILY_GROUP_TOTAL_COUNT; ++i)
+                target[SIZE * 4 + 2 + group * GroupTotals::LILY_GROUP_TOTAL_COUNT + i] =
+                    this->groups[group].totals[i].load(std::memory_order_relaxed);
+    }
+
+    void RequestHistograms::addSerialized(std::span<uint64_t const, SERIALIZED_SIZE> source)
+    {
+        constexpr auto SIZE {LatencyHistogram::SERIALIZED_SIZE};
+        this->handshake.addSerialized(source.subspan<0, SIZE>());
+        this->write.addSerialized(source.subspan<SIZE, SIZE>());
+        this->read.addSerialized(source.subspan<SIZE * 2, SIZE>());
+        this->total.addSerialized(source.subspan<SIZE * 3, SIZE>());
+        this->recordHandshakeBytes(source[SIZE * 4], source[SIZE * 4 + 1]);
+        for (std::size_t group {}; group < MAX_GROUP_COUNT; ++group)
+            for (std::size_t i {}; i < GroupTotals::LILY_GROUP_TOTAL_COUNT; ++i)
+                this->groups[group].totals[i].fetch_add(
+                    source[SIZE * 4 + 2 + group * GroupTotals::LILY_GROUP_TOTAL_COUNT + i], std::memory_order_relaxed);
+    }
+
+    void RequestHistograms::reset()
+    {
+        this->handshake.reset();
+        this->write.reset();
+        this->read.reset();
+        this->total.reset();
+        this->handshakeBytesSent.store(0, std::memory_order_relaxed);
+        this->handshakeBytesReceived.store(0, std::memory_order_relaxed);
+        for (auto& group: this->groups)
+            for (auto& total: group.totals)
+                total.store(0, std::memory_order_relaxed);
+    }
+} // namespace lily::log
@@ -0,0 +1,147 @@
+#include <cstring>
+#include <fmt/format.h>
+#include <fstream>
+#include <spdlog/spdlog.h>
+#include <vector>
+
+#include <lily/log/LogExport.h>
+#include <lily/log/LogFormat.h>
+
+using namespace lily::core;
+
+namespace lily::log
+{
+    // The records read from the binary log at once, and the size of the CSV written at once
+    static constexpr std::size_t READ_BLOCK_RECORDS {16384};
+    static constexpr std::size_t WRITE_BATCH_SIZE {1 << 20};
+
+    // A larger count of fields means the file isn't a binary log
+    static constexpr uint32_t MAX_FIELD_COUNT {256};
+
+    // Append the text of one packed field
+    template<class Value>
+    static void formatField(char const* bytes, std::string& batch)
+    {
+        Value value {};
+        std::memcpy(&value, bytes, sizeof(value));
+        fmt::format_to(std::back_inserter(batch), "{}", value);
+    }
+
+    Expect<uint64_t> exportCsv(std::filesystem::path const& input, std::filesystem::path const& output)
+    {
+        std::ifstream inputStream {input, std::ios::binary};
+        if (!inputStream.is_open())
+        {
+            spdlog::error("Lily-PQC export failed to open `{}`", input.string());
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+
+        // Check the header before trusting its sizes
+        BinaryLogHeader header {};
+        inputStream.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!inputStream or std::memcmp(header.magic, BinaryLogHeader::MAGIC, sizeof(header.magic)) != 0)
+        {
+            spdlog::error("Lily-PQC export failed! Why: `{}` isn't a binary log", input.string());
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+        if (header.version == 0 or header.version > BinaryLogHeader::VERSION or header.fieldCount == 0 or
+            header.fieldCount > MAX_FIELD_COUNT or header.recordSize == 0)
+        {
+            spdlog::error("Lily-PQC export failed! Why: `{}` has an unsupported version {} or layout", input.string(),
+                          header.version);
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+        std::vector<BinaryLogField> fields(header.fieldCount);
+        inputStream.read(reinterpret_cast<char*>(fields.data()), fields.size() * sizeof(BinaryLogField));
+        if (!inputStream)
+        {
+            spdlog::error("Lily-PQC export failed! Why: `{}` is truncated", input.string());
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+        for (auto const& field: fields)
+        {
+            if (field.offset + getFieldSize(field.type) > header.recordSize)
+            {
+                spdlog::error("Lily-PQC export failed! Why: `{}` has a field out of its records", input.string());
+                return ErrorCode::LILY_ERRORCODE_EXPECTED;
+            }
+        }
+
+        // A log which wasn't closed may hold fewer complete records than counted by its last flush
+        auto headerSize {sizeof(header) + fields.size() * sizeof(BinaryLogField)};
+        auto fileSize {std::filesystem::file_size(input)};
+        auto recordCount {std::min<uint64_t>(header.recordCount, (fileSize - headerSize) / header.recordSize)};
+
+        std::ofstream outputStream {output, std::ios::binary};
+        if (!outputStream.is_open())
+        {
+            spdlog::error("Lily-PQC export failed to create `{}`", output.string());
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+
+        // The header line names the columns, as the CSV log does
+        std::string batch {};
+        batch.reserve(WRITE_BATCH_SIZE * 2);
+        for (auto const& field: fields)
+            batch.append(field.name, strnlen(field.name, sizeof(field.name))).append(";");
+        batch.back() = '\r';
+        batch += '\n';
+
+        std::vector<char> block(READ_BLOCK_RECORDS * header.recordSize);
+        for (uint64_t exported {}; exported < recordCount;)
+        {
+            auto blockRecords {std::min<uint64_t>(READ_BLOCK_RECORDS, recordCount - exported)};
+            inputStream.read(block.data(), blockRecords * header.recordSize);
+            if (!inputStream)
+            {
+                spdlog::error("Lily-PQC export failed to read `{}`", input.string());
+                return ErrorCode::LILY_ERRORCODE_EXPECTED;
+            }
+
+            for (uint64_t i {}; i < blockRecords; ++i)
+            {
+                auto record {block.data() + i * header.recordSize};
+                for (auto const& field: fields)
+                {
+                    auto bytes {record + field.offset};
+                    switch (field.type)
+                    {
+                    case LogFieldType::LILY_FIELD_INT64:
+                        formatField<int64_t>(bytes, batch);
+                        break;
+                    case LogFieldType::LILY_FIELD_UINT64:
+                        formatField<uint64_t>(bytes, batch);
+                        break;
+                    case LogFieldType::LILY_FIELD_UINT32:
+                        formatField<uint32_t>(bytes, batch);
+                        break;
+                    case LogFieldType::LILY_FIELD_BOOL:
+                        batch += *bytes != 0 ? '1' : '0';
+                        break;
+                    case LogFieldType::LILY_FIELD_NAME:
+                        batch.append(bytes, strnlen(bytes, sizeof(LogName)));
+                        break;
+                    }
+                    batch += ';';
+                }
+                batch.back() = '\r';
+                batch += '\n';
+            }
+            exported += blockRecords;
+
+            if (batch.size() >= WRITE_BATCH_SIZE or exported == recordCount)
+            {
+                outputStream.write(batch.data(), batch.size());
+                batch.clear();
+            }
+        }
+        outputStream.write(batch.data(), batch.size());
+        outputStream.flush();
+        if (!outputStream)
+        {
+            spdlog::error("Lily-PQC export failed to write `{}`", output.string());
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+        return recordCount;
+    }
+} // namespace lily::log
@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <spdlog/spdlog.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+#include <lily/log/LogFile.h>
+
+namespace lily::log
+{
+    std::unique_ptr<LogFile> LogFile::create(std::string const& baseName, LogFormat format,
+                                             std::span<LogField const> fields)
+    {
+        if (format == LogFormat::LILY_LOG_FORMAT_CSV)
+        {
+            std::ofstream stream {baseName + ".csv"};
+            if (!stream.is_open())
+            {
+                spdlog::error("Failed to create record log `{}.csv`", baseName);
+                std::exit(EXIT_FAILURE);
+            }
+
+            // The header line names the columns
+            std::string header {};
+            for (auto const& field: fields)
+                header.append(field.name).append(";");
+            header.back() = '\r';
+            header += '\n';
+            stream.write(header.data(), header.size());
+            stream.flush();
+            return std::make_unique<TextLogFile>(std::move(stream));
+        }
+
+        auto fd {open((baseName + ".bin").c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)};
+        if (fd < 0)
+        {
+            spdlog::error("Failed to create record log `{}.bin`", baseName);
+            std::exit(EXIT_FAILURE);
+        }
+
+        // Describe the fields, so the file can be read without this version of the code
+        BinaryLogHeader header {};
+        std::copy(std::begin(BinaryLogHeader::MAGIC), std::end(BinaryLogHeader::MAGIC), header.magic);
+        header.version    = BinaryLogHeader::VERSION;
+        header.fieldCount = static_cast<uint32_t>(fields.size());
+        header.recordSize = getRecordSize(fields);
+        std::vector<BinaryLogField> binaryFields(fields.size());
+        uint32_t offset {};
+        for (std::size_t i {}; i < fields.size(); ++i)
+        {
+            fields[i].name.copy(binaryFields[i].name, sizeof(binaryFields[i].name) - 1);
+            binaryFields[i].type   = fields[i].type;
+            binaryFields[i].offset = offset;
+            offset += getFieldSize(fields[i].type);
+        }
+        auto fieldsSize {binaryFields.size() * sizeof(BinaryLogField)};
+        if (pwrite(fd, &header, sizeof(header), 0) != sizeof(header) or
+            pwrite(fd, binaryFields.data(), fieldsSize, sizeof(header)) != static_cast<ssize_t>(fieldsSize))
+        {
+            spdlog::error("Failed to write record log header `{}.bin`", baseName);
+            std::exit(EXIT_FAILURE);
+        }
+        return std::make_unique<MappedLogFile>(fd, header.recordSize, sizeof(header) + fieldsSize);
+    }
+
+    TextLogFile::TextLogFile(std::ofstream&& stream): stream(std::move(stream)) {}
+
+    void TextLogFile::append(std::string_view batch)
+    {
+        this->stream.write(batch.data(), batch.size());
+    }
+
+    void TextLogFile::flush()
+    {
+        this->stream.flush();
+    }
+
+    MappedLogFile::MappedLogFile(int fd, uint32_t recordSize, std::size_t headerSize):
+        fd(fd), recordSize(recordSize), headerSize(headerSize)
+    {
+    }
+
+    MappedLogFile::~MappedLogFile()
+    {
+        this->flush();
+        if (this->chunk)
+            munmap(this->chunk, CHUNK_SIZE);
+
+        // Drop the extension ahead of the last record
+        std::ignore = ftruncate(this->fd, this->headerSize + this->dataSize);
+        close(this->fd);
+    }
+
+    bool MappedLogFile::mapChunk(std::size_t offset)
+    {
+        if (this->chunk)
+            munmap(this->chunk, CHUNK_SIZE);
+        this->chunk       = nullptr;
+        this->chunkOffset = offset - offset % CHUNK_SIZE;
+
+        // Allocate the blocks now, so a full disk fails here instead of with a SIGBUS on the mapping
+        auto result {posix_fallocate(this->fd, this->chunkOffset, CHUNK_SIZE)};
+        if (result != 0)
+        {
+            spdlog::error("Lily-PQC record log extension failed! Why: {}", std::strerror(result));
+            return false;
+        }
+        auto chunk {mmap(nullptr, CHUNK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, this->chunkOffset)};
+        if (chunk == MAP_FAILED)
+        {
+            spdlog::error("Lily-PQC record log mapping failed! Why: {}", std::strerror(errno));
+            return false;
+        }
+        this->chunk = static_cast<char*>(chunk);
+        return true;
+    }
+
+    void MappedLogFile::append(std::string_view batch)
+    {
+        while (!batch.empty() and !this->failed)
+        {
+            // Move to the next chunk once the current one is full
+            auto offset {this->headerSize + this->dataSize};
+            if (!this->chunk or offset >= this->chunkOffset + CHUNK_SIZE)
+            {
+                this->failed = !this->mapChunk(offset);
+                continue;
+            }
+
+            auto size {std::min(batch.size(), this->chunkOffset + CHUNK_SIZE - offset)};
+            std::memcpy(this->chunk + (offset - this->chunkOffset), batch.data(), size);
+            this->dataSize += size;
+            batch.remove_prefix(size);
+        }
+    }
+
+    void MappedLogFile::flush()
+    {
+        // The pages are written back by the kernel, only the count of complete records has to be published
+        uint64_t recordCount {this->dataSize / this->recordSize};
+        std::ignore = pwrite(this->fd, &recordCount, sizeof(recordCount), offsetof(BinaryLogHeader, recordCount));
+    }
+} // namespace lily::log
@@ -0,0 +1,115 @@
+#include <cstddef>
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+
+#include <lily/log/PrimitiveLog.h>
+
+namespace lily::log
+{
+    static auto BOOTSTRAP_TIME {std::time(nullptr)};
+    static std::string filePrefix {};
+    static LogFormat logFormat {LogFormat::LILY_LOG_FORMAT_CSV};
+    static std::atomic<LogOverflow> overflow {LogOverflow::LILY_LOG_OVERFLOW_BLOCK};
+
+    std::array<LogField, 4> const PrimitiveLog::FIELDS {{
+        {"connection_id", LogFieldType::LILY_FIELD_UINT64, offsetof(Record, connectionId)},
+        {"operation", LogFieldType::LILY_FIELD_NAME, offsetof(Record, operation)},
+        {"algorithm", LogFieldType::LILY_FIELD_NAME, offsetof(Record, algorithm)},
+        {"duration_ns", LogFieldType::LILY_FIELD_UINT64, offsetof(Record, durationNs)},
+    }};
+
+    // The file name without its extension
+    static std::string getBaseName()
+    {
+        if (filePrefix.empty())
+            return fmt::format("{:%F_%T}_log_primitives", fmt::localtime(BOOTSTRAP_TIME));
+        return filePrefix + "_primitives";
+    }
+
+    PrimitiveLog::PrimitiveLog():
+        writer {LogFile::create(getBaseName(), logFormat, FIELDS),
+                logFormat == LogFormat::LILY_LOG_FORMAT_BINARY ? formatBinary : formatCsv, "primitive",
+                [this](Record const& record) { this->summarize(record); }}
+    {
+    }
+
+    void PrimitiveLog::setFilePrefix(std::string const& prefix)
+    {
+        filePrefix = prefix;
+    }
+
+    void PrimitiveLog::setFormat(LogFormat format)
+    {
+        logFormat = format;
+    }
+
+    void PrimitiveLog::setOverflow(LogOverflow policy)
+    {
+        overflow.store(policy, std::memory_order_relaxed);
+    }
+
+    PrimitiveLog& PrimitiveLog::getInstance()
+    {
+        static PrimitiveLog instance {};
+        return instance;
+    }
+
+    std::string_view PrimitiveLog::getOperationName(PrimitiveOperation operation)
+    {
+        switch (operation)
+        {
+        case PrimitiveOperation::LILY_PRIMITIVE_KEYGEN:
+            return "keygen";
+        case PrimitiveOperation::LILY_PRIMITIVE_ENCAPS:
+            return "encaps";
+        case PrimitiveOperation::LILY_PRIMITIVE_DECAPS:
+            return "decaps";
+        case PrimitiveOperation::LILY_PRIMITIVE_SIGN:
+            return "sign";
+        case PrimitiveOperation::LILY_PRIMITIVE_VERIFY:
+            return "verify";
+        }
+        return "unknown";
+    }
+
+    void PrimitiveLog::formatCsv(Record const& record, std::string& batch)
+    {
+        fmt::format_to(std::back_inserter(batch), "{};{};{};{}\r\n", record.connectionId,
+                       getLogName(record.operation), getLogName(record.algorithm), record.durationNs);
+    }
+
+    void PrimitiveLog::formatBinary(Record const& record, std::string& batch)
+    {
+        packRecord(record, FIELDS, batch);
+    }
+
+    void PrimitiveLog::summarize(Record const& record)
+    {
+        std::lock_guard lock {this->summaryMtx};
+        auto& histogram {this->summary[{std::string {getLogName(record.operation)},
+                                        std::string {getLogName(record.algorithm)}}]};
+        if (!histogram)
+            histogram = std::make_unique<LatencyHistogram>();
+        histogram->record(static_cast<int64_t>(record.durationNs));
+    }
+
+    void PrimitiveLog::write(uint64_t connectionId, PrimitiveOperation operation, char const* algorithm,
+                             uint64_t durationNs)
+    {
+        this->writer.write(
+            {connectionId, makeLogName(getOperationName(operation)), makeLogName(algorithm), durationNs},
+            overflow.load(std::memory_order_relaxed));
+    }
+
+    void PrimitiveLog::report()
+    {
+        // The samples still buffered, at most the last drain interval, are left out
+        std::lock_guard lock {this->summaryMtx};
+        for (auto const& [key, histogram]: this->summary)
+            fmt::print("[-] Primitive {} {} | Count: {} | Mean: {:.2f} µs | p50: {:.2f} µs | p99: {:.2f} µs | Max: "
+                       "{:.2f} µs\r\n",
+                       key.first, key.second, histogram->getCount(), histogram->getMean() / 1000.0,
+                       histogram->getPercentile(50.0) / 1000.0, histogram->getPercentile(99.0) / 1000.0,
+                       histogram->getMax() / 1000.0);
+    }
+} // namespace lily::log
@@ -0,0 +1,61 @@
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <pthread.h>
+#include <spdlog/spdlog.h>
+
+#include <lily/log/RecordWriter.h>
+
+namespace lily::log
+{
+    // Every writer alive, flushed on shutdown
+    static std::mutex sinksMtx {};
+    static std::vector<RecordSink*> sinks {};
+
+    RecordSink::RecordSink(std::string name): name(std::move(name)) {}
+
+    void RecordSink::registerSink()
+    {
+        std::lock_guard lock {sinksMtx};
+        sinks.push_back(this);
+    }
+
+    void RecordSink::unregisterSink()
+    {
+        std::lock_guard lock {sinksMtx};
+        std::erase(sinks, this);
+    }
+
+    void RecordSink::warnDropped(uint64_t droppedCount) const
+    {
+        if (droppedCount != 0)
+            spdlog::warn("Lily-PQC {} log dropped {} records, its writer didn't keep up", this->name, droppedCount);
+    }
+
+    void flushRecordWriters()
+    {
+        std::lock_guard lock {sinksMtx};
+        for (auto sink: sinks)
+            sink->flush();
+    }
+
+    void watchShutdownSignals()
+    {
+        sigset_t signals {};
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+        // The static objects aren't destroyed, the logging threads may still be using them
+        std::thread {[signals]
+                     {
+                         int signal {};
+                         sigwait(&signals, &signal);
+                         flushRecordWriters();
+                         std::fflush(nullptr);
+                         std::quick_exit(128 + signal);
+                     }}
+            .detach();
+    }
+} // namespace lily::log
@@ -6,15 +6,128 @@
 
 #include <lily/crypto/Key.h>
 #include <lily/crypto/OQSLoader.h>
-#include <lily/net/ClientConnection.h>
+#include <lily/crypto/PrimitiveBench.h>
+#include <lily/log/LogExport.h>
+#include <lily/log/RecordWriter.h>
+#include <lily/net/CapacitySearch.h>
+#include <lily/net/ClientCoordinator.h>
+#include <lily/net/ClientRunner.h>
 #include <lily/net/ServerListener.h>
+#include <lily/net/Sweep.h>
 
 using namespace lily::core;
 using namespace lily::crypto;
+using namespace lily::log;
 using namespace lily::net;
 
+// Add the server and engine options shared by every client command
+static void addClientOptions(CLI::App* command, ClientOptions& options)
+{
+    command->add_option("--server-host", options.serverHost, "The server host address (eg, 192.168.1.2)")
+        ->required()
+        ->check(CLI::TypeValidator<std::string> {});
+    command->add_option("--server-port", options.serverPort, "The server host port (eg, 7004)")
+        ->required()
+        ->check(CLI::PositiveNumber);
+    command
+        ->add_option("--threads", options.threads,
+                     "The number of threads running the users as coroutines (0 for one thread per user, or for every "
+                     "core in open loop)")
+        ->check(CLI::NonNegativeNumber);
+    command
+        ->add_option("--sni", options.serverName,
+                     "The SNI sent to the server, naming the certificate of a server with --certificate-dir")
+        ->check(CLI::TypeValidator<std::string> {});
+    command
+        ->add_option("--requests-per-connection", options.requestsPerConnection,
+                     "The number of requests sent over each connection before closing it (0 for unlimited)")
+        ->check(CLI::NonNegativeNumber);
+    command
+        ->add_option("--pipeline-depth", options.pipelineDepth,
+                     "The number of requests sent ahead of their responses on each connection")
+        ->check(CLI::PositiveNumber);
+    command
+        ->add_option("--resumption", options.resumption,
+                     "Whether each user resumes its last TLS session (none, ticket or cache)")
+        ->transform(CLI::CheckedTransformer(
+            std::map<std::string, ResumptionMode> {{"none", ResumptionMode::LILY_RESUMPTION_NONE},
+                                                   {"ticket", ResumptionMode::LILY_RESUMPTION_TICKET},
+                                                   {"cache", ResumptionMode::LILY_RESUMPTION_CACHE}},
+            CLI::ignore_case));
+    command->add_option("--arrival", options.arrival, "How the open-loop arrivals are spaced (constant or poisson)")
+        ->transform(CLI::CheckedTransformer(
+            std::map<std::string, ArrivalMode> {{"constant", ArrivalMode::LILY_ARRIVAL_CONSTANT},
+                                                {"poisson", ArrivalMode::LILY_ARRIVAL_POISSON}},
+            CLI::ignore_case));
+    command
+        ->add_option("--payload-distribution", options.payloadDistribution,
+                     "How the size of each body is drawn (fixed, uniform, lognormal or empirical)")
+        ->transform(CLI::CheckedTransformer(
+            std::map<std::string, PayloadDistribution> {{"fixed", PayloadDistribution::LILY_PAYLOAD_FIXED},
+                                                        {"uniform", PayloadDistribution::LILY_PAYLOAD_UNIFORM},
+                                                        {"lognormal", PayloadDistribution::LILY_PAYLOAD_LOGNORMAL},
+                                                        {"empirical", PayloadDistribution::LILY_PAYLOAD_EMPIRICAL}},
+            CLI::ignore_case));
+    command
+        ->add_option("--data-length-min", options.payloadMinLength,
+                     "The smallest body of the uniform and lognormal distributions (in bytes)")
+        ->check(CLI::NonNegativeNumber);
+    command
+        ->add_option("--data-length-max", options.payloadMaxLength,
+                     "The largest body of the lognormal distribution (in bytes, 16 times the data length by default)")
+        ->check(CLI::NonNegativeNumber);
+    command
+        ->add_option("--data-length-sigma", options.payloadSigma,
+                     "The standard deviation of the logarithm of the lognormal body sizes")
+        ->check(CLI::PositiveNumber);
+    command
+        ->add_option("--payload-histogram", options.payloadHistogramFile,
+                     "The file of the empirical distribution, one `size;weight` line per body size")
+        ->check(CLI::ExistingFile);
+    command->add_option("--log-format", options.logFormat, "How the log records are stored (csv or binary)")
+        ->transform(CLI::CheckedTransformer(
+            std::map<std::string, LogFormat> {{"csv", LogFormat::LILY_LOG_FORMAT_CSV},
+                                              {"binary", LogFormat::LILY_LOG_FORMAT_BINARY}},
+            CLI::ignore_case));
+    command
+        ->add_option("--log-overflow", options.logOverflow,
+                     "What a user does when its buffer of log records is full (block or drop)")
+        ->transform(CLI::CheckedTransformer(
+            std::map<std::string, LogOverflow> {{"block", LogOverflow::LILY_LOG_OVERFLOW_BLOCK},
+                                                {"drop", LogOverflow::LILY_LOG_OVERFLOW_DROP}},
+            CLI::ignore_case));
+    command->add_flag("--cold-setup", options.coldSetup,
+                      "Resolve the server and build the TLS context and the request again on each connection");
+    command->add_flag("--ktls", options.ktls,
+                      "Encrypt the records in the kernel (kTLS) after the handshake, when supported");
+}
+
+// Add the options of the load measured by a client command, varied by `sweep` instead
+static void addClientLoadOptions(CLI::App* command, ClientOptions& options)
+{
+    command->add_option("--concurrent-user", options.concurrentUsers, "The number of concurrent user")
+        ->required()
+        ->check(CLI::PositiveNumber);
+    command->add_option("--tls-group", options.tlsGroup, "The TLS group used")
+        ->required()
+        ->check(CLI::TypeValidator<std::string> {});
+    command
+        ->add_option("--sigalgs", options.sigalgs,
+                     "The signature algorithms offered to the server (eg, mldsa65:falcon512), all the supported ones "
+                     "by default")
+        ->check(CLI::TypeValidator<std::string> {});
+    command
+        ->add_option("--data-length", options.dummyDataLength,
+                     "The size of the data to be transmitted to the server (in bytes)")
+        ->required()
+        ->check(CLI::PositiveNumber);
+}
+
 int32_t main(int32_t argc, char** argv)
 {
+    // Flush the logs when interrupted, before any thread is started
+    watchShutdownSignals();
+
     // Load OQS provider to OpenSSL
     if (!loadOQSProvider())
         return EXIT_FAILURE;
@@ -24,31 +137,99 @@ int32_t main(int32_t argc, char** argv)
 
     // Handle `main run-server` execution
     auto mainRunServer {main.add_subcommand("server-run", "Run application as server")};
-    std::filesystem::path certificateFile {};
-    std::filesystem::path privateKeyFile {};
-    uint16_t port {};
+    ServerOptions serverOptions {};
     {
+        auto certificateFileOption {
+            mainRunServer
+                ->add_option("--certificate-file", serverOptions.certificatePath,
+                             "The absolute path to the server's certificate file, in PEM format")
+                ->check(CLI::ExistingFile)};
+        auto privateKeyFileOption {
+            mainRunServer
+                ->add_option("--private-key-file", serverOptions.privateKeyPath,
+                             "The absolute path to the server's private key file, in PEM format")
+                ->check(CLI::ExistingFile)};
+        certificateFileOption->needs(privateKeyFileOption);
+        privateKeyFileOption->needs(certificateFileOption);
         mainRunServer
-            ->add_option("--certificate-file", certificateFile,
-                         "The absolute path to the server's certificate file, in PEM format")
+            ->add_option("--certificate-dir", serverOptions.certificateDirectory,
+                         "The directory of <name>.crt and <name>.key pairs, chosen by the client SNI and signature "
+                         "algorithms (replaces --certificate-file and --private-key-file)")
+            ->check(CLI::ExistingDirectory)
+            ->excludes(certificateFileOption)
+            ->excludes(privateKeyFileOption);
+        mainRunServer->add_option("--port", serverOptions.port, "The server listener port")
             ->required()
-            ->check(CLI::ExistingFile);
+            ->check(CLI::PositiveNumber);
         mainRunServer
-            ->add_option("--private-key-file", privateKeyFile,
-                         "The absolute path to the server's private key file, in PEM format")
-            ->required()
-            ->check(CLI::ExistingFile);
-        mainRunServer->add_option("--port", port, "The server listener port")->required()->check(CLI::PositiveNumber);
+            ->add_option("--threads", serverOptions.threads,
+                         "The number of worker threads of the asynchronous engine (0 keeps one thread per connection)")
+            ->check(CLI::NonNegativeNumber);
+        mainRunServer
+            ->add_option("--shards", serverOptions.shards,
+                         "The number of shards, each with its own SO_REUSEPORT acceptor and thread pinned to one core")
+            ->check(CLI::NonNegativeNumber);
+        mainRunServer
+            ->add_option("--session-cache-size", serverOptions.sessionCacheSize,
+                         "The size of the stateful session cache (0 keeps the resumption stateless)")
+            ->check(CLI::NonNegativeNumber);
+        mainRunServer
+            ->add_option("--session-tickets", serverOptions.sessionTickets,
+                         "The number of TLS 1.3 session tickets sent after each full handshake (0 disables it)")
+            ->check(CLI::NonNegativeNumber);
+        mainRunServer
+            ->add_option("--max-handshakes", serverOptions.maxHandshakes,
+                         "The maximum number of handshakes in flight (0 leaves the handshakes unlimited)")
+            ->check(CLI::NonNegativeNumber);
+        mainRunServer
+            ->add_option("--admission-queue-size", serverOptions.admissionQueueSize,
+                         "The number of connections waiting for a handshake slot with the queue overflow policy")
+            ->check(CLI::NonNegativeNumber);
+        mainRunServer
+            ->add_option("--overflow-policy", serverOptions.overflowPolicy,
+                         "What happens to a connection when every handshake slot is taken (queue, reject or delay)")
+            ->transform(CLI::CheckedTransformer(
+                std::map<std::string, OverflowPolicy> {{"queue", OverflowPolicy::LILY_OVERFLOW_QUEUE},
+                                                       {"reject", OverflowPolicy::LILY_OVERFLOW_REJECT},
+                                                       {"delay", OverflowPolicy::LILY_OVERFLOW_DELAY}},
+                CLI::ignore_case));
+        mainRunServer
+            ->add_option("--stream-window", serverOptions.streamWindow,
+                         "The window size (in bytes) used to stream the echoed bodies (0 buffers each whole body)")
+            ->check(CLI::NonNegativeNumber);
+        mainRunServer
+            ->add_option("--pool-size", serverOptions.poolSize,
+                         "The number of SSL objects and read buffers recycled by each worker (0 disables the pooling)")
+            ->check(CLI::NonNegativeNumber);
+        mainRunServer
+            ->add_option("--log-format", serverOptions.logFormat, "How the log records are stored (csv or binary)")
+            ->transform(CLI::CheckedTransformer(
+                std::map<std::string, LogFormat> {{"csv", LogFormat::LILY_LOG_FORMAT_CSV},
+                                                  {"binary", LogFormat::LILY_LOG_FORMAT_BINARY}},
+                CLI::ignore_case));
+        mainRunServer
+            ->add_option("--log-overflow", serverOptions.logOverflow,
+                         "What a connection does when its thread buffer of log records is full (block or drop)")
+            ->transform(CLI::CheckedTransformer(
+                std::map<std::string, LogOverflow> {{"block", LogOverflow::LILY_LOG_OVERFLOW_BLOCK},
+                                                    {"drop", LogOverflow::LILY_LOG_OVERFLOW_DROP}},
+                CLI::ignore_case));
+        mainRunServer
+            ->add_option("--metrics-port", serverOptions.metricsPort,
+                         "The port of the plain-HTTP Prometheus metrics endpoint (0 disables the endpoint)")
+            ->check(CLI::NonNegativeNumber);
+        mainRunServer->add_flag("--ktls", serverOptions.ktls,
+                                "Encrypt the records in the kernel (kTLS) after the handshake, when supported");
         mainRunServer->callback(
             [&]
             {
                 // Initialize the server with its configuration
-                auto outcomeListener {ServerListener::create(port, certificateFile, privateKeyFile)};
+                auto outcomeListener {ServerListener::create(serverOptions)};
                 if (!outcomeListener)
                     return std::exit(EXIT_FAILURE);
                 auto listener {std::move(outcomeListener.assume_value())};
 
-                fmt::print(fmt::fg(fmt::color::green), "[v] Listening to port {}...\r\n", port);
+                fmt::print(fmt::fg(fmt::color::green), "[v] Listening to port {}...\r\n", serverOptions.port);
 
                 // Listen to the given port
                 listener.run();
@@ -91,73 +272,215 @@ int32_t main(int32_t argc, char** argv)
 
     // Handle `main run-client` execution
     auto mainRunClient {main.add_subcommand("client-run", "Run application as client")};
-    std::string serverHost {};
-    uint16_t serverPort {};
-    uint32_t concurrentNum {};
-    std::string tlsGroup {};
-    uint32_t dummyDataLength {};
+    ClientOptions clientOptions {};
     {
-        mainRunClient->add_option("--server-host", serverHost, "The server host address (eg, 192.168.1.2)")
+        addClientOptions(mainRunClient, clientOptions);
+        addClientLoadOptions(mainRunClient, clientOptions);
+        mainRunClient
+            ->add_option("--rate", clientOptions.rate,
+                         "The number of connections started per second whatever the responses, with the users as the "
+                         "maximum in flight (open loop)")
+            ->check(CLI::PositiveNumber);
+        mainRunClient
+            ->add_option("--duration", clientOptions.durationSeconds,
+                         "Stop the run after this time and save its result (in seconds)")
+            ->check(CLI::PositiveNumber);
+        mainRunClient
+            ->add_option("--total-requests", clientOptions.totalRequests,
+                         "Stop the run after this number of requests and save its result")
+            ->check(CLI::PositiveNumber);
+        mainRunClient
+            ->add_option("--processes", clientOptions.processes,
+                         "The number of worker processes sharing the users and the rate, each one with --threads")
+            ->check(CLI::PositiveNumber);
+        mainRunClient->callback(
+            [&]
+            {
+                // Split the users between the worker processes, before any thread is started
+                if (clientOptions.processes > 1)
+                {
+                    auto outcomeCoordinator {ClientCoordinator::create(clientOptions)};
+                    if (!outcomeCoordinator)
+                        return std::exit(EXIT_FAILURE);
+
+                    return outcomeCoordinator.assume_value()->run();
+                }
+
+                // Initialize the users with their shared setup
+                auto outcomeRunner {ClientRunner::create(clientOptions)};
+                if (!outcomeRunner)
+                    return std::exit(EXIT_FAILURE);
+
+                outcomeRunner.assume_value()->run();
+            });
+    }
+
+    // Handle `main capacity-search` execution, `client-capacity-search` is kept as an alias
+    auto mainCapacitySearch {main.add_subcommand(
+        "capacity-search", "Raise the open-loop load on the server until it breaks the latency SLO or the error "
+                           "budget, then report the knee point")};
+    mainCapacitySearch->alias("client-capacity-search");
+    CapacitySearchOptions capacitySearchOptions {};
+    {
+        addClientOptions(mainCapacitySearch, clientOptions);
+        addClientLoadOptions(mainCapacitySearch, clientOptions);
+        mainCapacitySearch
+            ->add_option("--start-rate", capacitySearchOptions.startRate,
+                         "The first offered rate, in connections per second")
+            ->check(CLI::PositiveNumber);
+        mainCapacitySearch
+            ->add_option("--max-rate", capacitySearchOptions.maxRate,
+                         "The highest offered rate, in connections per second")
+            ->check(CLI::PositiveNumber);
+        mainCapacitySearch
+            ->add_option("--step-rate", capacitySearchOptions.stepRate,
+                         "The rate added after each passing step (0 doubles the rate, then bisects)")
+            ->check(CLI::NonNegativeNumber);
+        mainCapacitySearch
+            ->add_option("--precision", capacitySearchOptions.precision,
+                         "The bisection stops once the failing rate is within this fraction of the passing one")
+            ->check(CLI::Range(0.001, 1.0));
+        mainCapacitySearch
+            ->add_option("--slo-p99-ms", capacitySearchOptions.sloP99Ms, "The highest p99 latency of a passing step")
+            ->check(CLI::PositiveNumber);
+        mainCapacitySearch
+            ->add_option("--max-error-rate", capacitySearchOptions.maxErrorRate,
+                         "The highest fraction of failed requests and dropped arrivals of a passing step")
+            ->check(CLI::Range(0.0, 1.0));
+        mainCapacitySearch
+            ->add_option("--warm-up", capacitySearchOptions.warmUpSeconds,
+                         "The time given to the server to reach its steady state on each step (in seconds)")
+            ->check(CLI::NonNegativeNumber);
+        mainCapacitySearch
+            ->add_option("--window", capacitySearchOptions.windowSeconds,
+                         "The time measured on each step once warmed up (in seconds)")
+            ->check(CLI::PositiveNumber);
+        mainCapacitySearch->callback(
+            [&]
+            {
+                // Initialize the users with their shared setup
+                auto outcomeSearch {CapacitySearch::create(clientOptions, capacitySearchOptions)};
+                if (!outcomeSearch)
+                    return std::exit(EXIT_FAILURE);
+
+                auto knee {outcomeSearch.assume_value().run()};
+                if (!knee)
+                {
+                    fmt::print(fmt::fg(fmt::color::red),
+                               "[-] No load of `{}` stays within the SLO, even {:.1f} conn/s\r\n",
+                               clientOptions.tlsGroup, capacitySearchOptions.startRate);
+                    return std::exit(EXIT_FAILURE);
+                }
+                fmt::print(fmt::fg(fmt::color::green),
+                           "[v] Knee point of `{}`: {:.2f} req/s at {:.1f} conn/s | p50: {:.2f} ms | p99: {:.2f} "
+                           "ms\r\n",
+                           clientOptions.tlsGroup, knee->tps, knee->offeredRate, knee->p50LatencyUs / 1000.0,
+                           knee->p99LatencyUs / 1000.0);
+            });
+    }
+
+    // Handle `main sweep` execution, `client-sweep` is kept as an alias
+    auto mainSweep {main.add_subcommand("sweep", "Measure every combination of TLS group, signature algorithm, data "
+                                                 "length and concurrency, then save the comparative table")};
+    mainSweep->alias("client-sweep");
+    SweepOptions sweepOptions {};
+    {
+        addClientOptions(mainSweep, clientOptions);
+        mainSweep
+            ->add_option("--tls-groups", sweepOptions.tlsGroups,
+                         "The TLS groups measured, comma separated (eg, mlkem768,x25519_mlkem768), or `all`")
             ->required()
-            ->check(CLI::TypeValidator<std::string> {});
-        mainRunClient->add_option("--server-port", serverPort, "The server host port (eg, 7004)")
+            ->delimiter(',');
+        mainSweep
+            ->add_option("--sigalgs-list", sweepOptions.sigalgs,
+                         "The signature algorithms offered alone, comma separated, or `all` (all at once by default)")
+            ->delimiter(',');
+        mainSweep
+            ->add_option("--data-lengths", sweepOptions.dataLengths,
+                         "The sizes of the data transmitted to the server, comma separated (in bytes)")
             ->required()
+            ->delimiter(',')
             ->check(CLI::PositiveNumber);
-        mainRunClient->add_option("--concurrent-user", concurrentNum, "The number of concurrent user")
+        mainSweep
+            ->add_option("--concurrent-users", sweepOptions.concurrentUsers,
+                         "The numbers of concurrent users, comma separated")
             ->required()
+            ->delimiter(',')
             ->check(CLI::PositiveNumber);
-        mainRunClient->add_option("--tls-group", tlsGroup, "The TLS group used")
-            ->required()
-            ->check(CLI::TypeValidator<std::string> {});
-        mainRunClient
-            ->add_option("--data-length", dummyDataLength, "The size of the data to be transmitted to the server (in bytes)")
+        mainSweep
+            ->add_option("--warm-up", sweepOptions.warmUpSeconds,
+                         "The time given to the server to reach its steady state on each cell (in seconds)")
+            ->check(CLI::NonNegativeNumber);
+        mainSweep
+            ->add_option("--window", sweepOptions.windowSeconds,
+                         "The time measured on each cell once warmed up (in seconds)")
+            ->check(CLI::PositiveNumber);
+        mainSweep->callback([&] { Sweep {clientOptions, sweepOptions}.run(); });
+    }
+
+    // Handle `main bench-kem` and `main bench-sig` execution
+    auto mainBenchKem {main.add_subcommand("bench-kem", "Measure the key generation, encapsulation and decapsulation "
+                                                        "throughput of KEM algorithms, without TLS")};
+    auto mainBenchSig {main.add_subcommand("bench-sig", "Measure the key generation, signature and verification "
+                                                        "throughput of signature algorithms, without TLS")};
+    BenchOptions benchOptions {};
+    for (auto mainBench: {mainBenchKem, mainBenchSig})
+    {
+        mainBench
+            ->add_option("--algorithms", benchOptions.algorithms,
+                         mainBench == mainBenchKem
+                             ? "The KEM algorithms measured, comma separated (eg, mlkem768,x25519_mlkem768), or `all`"
+                             : "The signature algorithms measured, comma separated (eg, mldsa65,falcon512), or `all`")
             ->required()
+            ->delimiter(',');
+        mainBench
+            ->add_option("--threads", benchOptions.threads,
+                         "The numbers of threads running the primitives, comma separated (one thread is always "
+                         "measured first)")
+            ->delimiter(',')
             ->check(CLI::PositiveNumber);
-        mainRunClient->callback(
+        mainBench
+            ->add_option("--duration", benchOptions.durationSeconds,
+                         "The time measured for each algorithm and number of threads (in seconds)")
+            ->check(CLI::PositiveNumber);
+        mainBench->add_option("--output", benchOptions.outputPath,
+                              "The JSON file of the results (named after the start time by default)");
+    }
+    mainBenchKem->callback(
+        [&]
+        {
+            benchOptions.kind = BenchKind::LILY_BENCH_KEM;
+            PrimitiveBench {benchOptions}.run();
+        });
+    mainBenchSig->callback(
+        [&]
+        {
+            benchOptions.kind = BenchKind::LILY_BENCH_SIG;
+            PrimitiveBench {benchOptions}.run();
+        });
+
+    // Handle `main export` execution
+    auto mainExport {main.add_subcommand("export", "Convert a binary log to the CSV layout of the text log")};
+    std::filesystem::path exportInput {};
+    std::filesystem::path exportOutput {};
+    {
+        mainExport
+            ->add_option("--input", exportInput, "The binary log to convert (eg, 2025-01-01_10:00:00_log_client.bin)")
+            ->required()
+            ->check(CLI::ExistingFile);
+        mainExport->add_option("--output", exportOutput, "The CSV file to create (the input with `.csv` by default)");
+        mainExport->callback(
             [&]
             {
-                // Record total request
-                std::atomic_int64_t totalSuccessfulRequest {};
-                std::atomic_int64_t totalFailedRequest {};
-
-                // Set-up concurrent users pool
-                std::vector<std::jthread> userThreads(concurrentNum);
-                for (auto& thread: userThreads)
-                    thread = std::jthread {
-                        [&]
-                        {
-                            // Send dummy data repeatedly
-                            while (true)
-                            {
-                                if (!ClientConnection::sendDummyData(serverHost, serverPort, tlsGroup, dummyDataLength))
-                                    ++totalFailedRequest;
-                                else
-                                    ++totalSuccessfulRequest;
-                            }
-                        }};
-
-                //
-                std::jthread totalRequestPrinter {
-                    [&]
-                    {
-                        auto startTime {std::chrono::high_resolution_clock::now()};
-
-                        while (true)
-                        {
-                            std::this_thread::sleep_for(std::chrono::seconds {5});
-
-                            auto elapsedTime {std::chrono::high_resolution_clock::now() - startTime};
-                            fmt::print("[-] Successful Request: {} | Failed Request: {} | TPS : {:.2f} req/s\r\n",
-                                       totalSuccessfulRequest.load(), totalFailedRequest.load(),
-                                       static_cast<double>(totalSuccessfulRequest.load() + totalFailedRequest.load()) /
-                                           std::chrono::duration_cast<std::chrono::seconds>(elapsedTime).count());
-                        }
-                    }};
-
-                fmt::print(fmt::fg(fmt::color::green), "[v] All users is active and testing the server!\r\n");
-
-                for (auto& thread: userThreads)
-                    thread.join();
+                if (exportOutput.empty())
+                    exportOutput = std::filesystem::path {exportInput}.replace_extension(".csv");
+
+                auto outcomeExport {exportCsv(exportInput, exportOutput)};
+                if (!outcomeExport)
+                    return std::exit(EXIT_FAILURE);
+
+                fmt::print(fmt::fg(fmt::color::green), "[v] {} records exported to `{}`\r\n",
+                           outcomeExport.assume_value(), exportOutput.string());
             });
     }
 
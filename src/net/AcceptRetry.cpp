@@ -0,0 +1,26 @@
+#include <chrono>
+#include <spdlog/spdlog.h>
+
+#include <lily/net/AcceptRetry.h>
+
+namespace lily::net
+{
+    // The time waited after a failed accept
+    static constexpr std::chrono::seconds ACCEPT_RETRY_DELAY {1};
+
+    boost::asio::awaitable<bool> retryAccept(boost::asio::ip::tcp::acceptor& acceptor,
+                                             boost::beast::error_code const& ec, std::string_view name)
+    {
+        // The server is shutting down
+        if (ec == boost::asio::error::operation_aborted or !acceptor.is_open())
+            co_return false;
+
+        spdlog::error("Lily-PQC {} accept failed! Why: {}", name, ec.message());
+
+        // The wait is cut short if the server stops meanwhile, the next accept then fails with `operation_aborted`
+        boost::beast::error_code waitEc {};
+        boost::asio::steady_timer timer {co_await boost::asio::this_coro::executor, ACCEPT_RETRY_DELAY};
+        co_await timer.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, waitEc));
+        co_return true;
+    }
+} // namespace lily::net
@@ -0,0 +1,228 @@
+#include <chrono>
+#include <spdlog/spdlog.h>
+
+#include <lily/log/ServerLog.h>
+#include <lily/net/AsyncServerSession.h>
+#include <lily/net/ConnectionTrace.h>
+#include <lily/net/KtlsStream.h>
+#include <lily/net/ServerMetrics.h>
+#include <lily/net/ServerSession.h>
+
+using namespace lily::log;
+
+namespace lily::net
+{
+    boost::asio::awaitable<void> AsyncServerSession::run()
+    {
+        // Variable that collect the error code thrown by boost function
+        boost::beast::error_code ec {};
+
+        // Set the timeout.
+        boost::beast::get_lowest_layer(this->stream).expires_never();
+
+        auto& metrics {ServerMetrics::getInstance()};
+        metrics.recordAccepted();
+
+        // Wait for a handshake slot, or shed the connection with a TCP reset
+        if (this->admission and !this->admitted and !co_await this->admission->asyncAcquire())
+        {
+            metrics.recordShed();
+            HandshakeAdmission::reset(boost::beast::get_lowest_layer(this->stream).socket());
+            co_return;
+        }
+
+        // Perform the SSL handshake and measure the handshake time using `std::chrono`. This will measure the whole
+        // handshake process duration, including the time spent waiting for the client flights, and the trace splits
+        // it between the handshake messages.
+        metrics.recordHandshakeStarted();
+        auto beginHandshakeTime {std::chrono::high_resolution_clock::now()};
+        log::HandshakePhases phases {};
+        log::HandshakeTraffic traffic {};
+        log::NegotiatedParameters parameters {};
+        log::ConnectionContext context {};
+        {
+            ConnectionTrace trace {this->stream.native_handle()};
+            co_await this->stream.async_handshake(boost::asio::ssl::stream_base::server,
+                                                  boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+            phases     = trace.getPhases();
+            traffic    = trace.getTraffic();
+            parameters = trace.getParameters();
+            context    = trace.getContext();
+        }
+        auto handshakeDuration {std::chrono::duration_cast<std::chrono::microseconds>(
+                                    std::chrono::high_resolution_clock::now() - beginHandshakeTime)
+                                    .count()};
+        if (this->admission)
+            this->admission->release();
+        metrics.recordHandshake(handshakeDuration, ec);
+        if (ec)
+        {
+            if (ec != boost::beast::net::ssl::error::stream_truncated and ec != boost::asio::error::broken_pipe and
+                ec != boost::asio::error::connection_reset)
+                spdlog::error("Lily-PQC server SSL handshake with client failed! Why: {}", ec.message());
+            co_return;
+        }
+        if (this->handshakeCount)
+            this->handshakeCount->fetch_add(1, std::memory_order_relaxed);
+
+        while (true)
+        {
+            // Forward the body chunks as they are decrypted, so the memory stays bounded by the window
+            if (!this->window.empty())
+            {
+                auto keep_alive {
+                    co_await this->echoStreaming(handshakeDuration, phases, traffic, parameters, context, ec)};
+                if (ec == boost::beast::http::error::end_of_stream)
+                    break;
+                if (ec)
+                    co_return;
+                if (!keep_alive)
+                    break;
+                continue;
+            }
+
+            boost::beast::http::request<boost::beast::http::string_body> req {};
+
+            // Perform the SSL read and measure the duration
+            auto beginReadTime {std::chrono::high_resolution_clock::now()};
+            auto readSize {co_await boost::beast::http::async_read(
+                this->stream, this->buffer, req, boost::asio::redirect_error(boost::asio::use_awaitable, ec))};
+            auto readDuration {std::chrono::duration_cast<std::chrono::microseconds>(
+                                   std::chrono::high_resolution_clock::now() - beginReadTime)
+                                   .count()};
+            if (ec == boost::beast::http::error::end_of_stream)
+                break;
+            if (ec)
+                co_return;
+
+            // Handle request
+            auto res {ServerSession::makeEchoResponse(std::move(req))};
+
+            // Determine if we should close the connection
+            bool keep_alive {res.keep_alive()};
+
+            // Send the response
+            auto beginWriteTime {std::chrono::high_resolution_clock::now()};
+            auto writeSize {co_await boost::beast::http::async_write(
+                this->stream, res, boost::asio::redirect_error(boost::asio::use_awaitable, ec))};
+            auto writeDuration {std::chrono::duration_cast<std::chrono::microseconds>(
+                                    std::chrono::high_resolution_clock::now() - beginWriteTime)
+                                    .count()};
+            if (ec)
+            {
+                if (ec != boost::beast::net::ssl::error::stream_truncated and ec != boost::asio::error::broken_pipe and
+                    ec != boost::asio::error::connection_reset)
+                    spdlog::error("Lily-PQC server SSL write to client failed! Why: {}", ec.message());
+                co_return;
+            }
+
+            // Log server SSL performance
+            metrics.recordRequest(readSize, readDuration, writeSize, writeDuration);
+            auto [ktlsSend, ktlsRecv] {KtlsStream::getOffload(this->stream)};
+            ServerLog::getInstance().write(handshakeDuration, phases, traffic, readSize, readDuration, writeSize,
+                                           writeDuration, SSL_session_reused(this->stream.native_handle()) == 1,
+                                           ktlsSend, ktlsRecv, parameters, context.id, context.primitives);
+
+            if (!keep_alive)
+            {
+                // This means we should close the connection, usually because
+                // the response indicated the "Connection: close" semantic.
+                break;
+            }
+        }
+
+        // Perform the SSL shutdown
+        co_await this->close();
+    }
+
+    boost::asio::awaitable<bool> AsyncServerSession::echoStreaming(int64_t handshakeDuration,
+                                                                   log::HandshakePhases const& phases,
+                                                                   log::HandshakeTraffic const& traffic,
+                                                                   log::NegotiatedParameters const& parameters,
+                                                                   log::ConnectionContext const& context,
+                                                                   boost::beast::error_code& ec)
+    {
+        // The request body is parsed into the window instead of a growing string, so its size isn't limited
+        boost::beast::http::request_parser<boost::beast::http::buffer_body> parser {};
+        parser.body_limit(std::numeric_limits<uint64_t>::max());
+
+        // Perform the SSL read of the request header
+        auto beginReadTime {std::chrono::high_resolution_clock::now()};
+        auto readSize {co_await boost::beast::http::async_read_header(
+            this->stream, this->buffer, parser, boost::asio::redirect_error(boost::asio::use_awaitable, ec))};
+        auto readDuration {std::chrono::high_resolution_clock::now() - beginReadTime};
+        if (ec)
+            co_return false;
+
+        // Send the response header, the response body is written chunk by chunk below
+        auto res {ServerSession::makeStreamingEchoResponse(parser)};
+        boost::beast::http::response_serializer<boost::beast::http::buffer_body> serializer {res};
+        auto beginWriteTime {std::chrono::high_resolution_clock::now()};
+        auto writeSize {co_await boost::beast::http::async_write_header(
+            this->stream, serializer, boost::asio::redirect_error(boost::asio::use_awaitable, ec))};
+        auto writeDuration {std::chrono::high_resolution_clock::now() - beginWriteTime};
+
+        while (!ec and !serializer.is_done())
+        {
+            // Decrypt the next request body chunk into the window
+            auto& reqBody {parser.get().body()};
+            reqBody.data = this->window.data();
+            reqBody.size = this->window.size();
+            if (!parser.is_done())
+            {
+                beginReadTime = std::chrono::high_resolution_clock::now();
+                readSize += co_await boost::beast::http::async_read(
+                    this->stream, this->buffer, parser, boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+                readDuration += std::chrono::high_resolution_clock::now() - beginReadTime;
+                if (ec == boost::beast::http::error::need_buffer)
+                    ec = {};
+                if (ec)
+                    co_return false;
+            }
+
+            // Forward the chunk to the response
+            auto& resBody {res.body()};
+            resBody.data = this->window.data();
+            resBody.size = this->window.size() - reqBody.size;
+            resBody.more = !parser.is_done();
+            beginWriteTime = std::chrono::high_resolution_clock::now();
+            writeSize += co_await boost::beast::http::async_write(
+                this->stream, serializer, boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+            writeDuration += std::chrono::high_resolution_clock::now() - beginWriteTime;
+            if (ec == boost::beast::http::error::need_buffer)
+                ec = {};
+        }
+        if (ec)
+        {
+            if (ec != boost::beast::net::ssl::error::stream_truncated and ec != boost::asio::error::broken_pipe and
+                ec != boost::asio::error::connection_reset)
+                spdlog::error("Lily-PQC server SSL write to client failed! Why: {}", ec.message());
+            co_return false;
+        }
+
+        // Log server SSL performance
+        auto readUs {std::chrono::duration_cast<std::chrono::microseconds>(readDuration).count()};
+        auto writeUs {std::chrono::duration_cast<std::chrono::microseconds>(writeDuration).count()};
+        ServerMetrics::getInstance().recordRequest(readSize, readUs, writeSize, writeUs);
+        auto [ktlsSend, ktlsRecv] {KtlsStream::getOffload(this->stream)};
+        ServerLog::getInstance().write(handshakeDuration, phases, traffic, readSize, readUs, writeSize, writeUs,
+                                       SSL_session_reused(this->stream.native_handle()) == 1, ktlsSend, ktlsRecv,
+                                       parameters, context.id, context.primitives);
+        co_return res.keep_alive();
+    }
+
+    boost::asio::awaitable<void> AsyncServerSession::close()
+    {
+        // Variable that collect the error code thrown by boost function
+        boost::beast::error_code ec {};
+
+        // Perform the SSL shutdown
+        co_await this->stream.async_shutdown(boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+        if (ec)
+        {
+            if (ec != boost::beast::net::ssl::error::stream_truncated and ec != boost::asio::error::broken_pipe and
+                ec != boost::asio::error::connection_reset)
+                spdlog::error("Lily-PQC server SSL shutdown to client failed! Why: {}", ec.message());
+        }
+    }
+} // namespace lily::net
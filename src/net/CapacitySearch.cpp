@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <fmt/color.h>
+#include <fmt/core.h>
+
+#include <lily/net/CapacitySearch.h>
+
+using namespace lily::core;
+
+namespace lily::net
+{
+    CapacitySearch::CapacitySearch(CapacitySearchOptions const& options, std::unique_ptr<ClientRunner> runner):
+        options(options), runner(std::move(runner))
+    {
+    }
+
+    Expect<CapacitySearch> CapacitySearch::create(ClientOptions const& clientOptions,
+                                                  CapacitySearchOptions const& options)
+    {
+        auto outcomeRunner {ClientRunner::create(clientOptions)};
+        if (!outcomeRunner)
+            return outcomeRunner.error();
+        return CapacitySearch {options, std::move(outcomeRunner.assume_value())};
+    }
+
+    bool CapacitySearch::measureStep(double rate, ClientRunner::Measurement& measurement)
+    {
+        measurement = this->runner->measure(rate, std::chrono::seconds {this->options.warmUpSeconds},
+                                            std::chrono::seconds {this->options.windowSeconds});
+
+        auto p99LatencyMs {measurement.p99LatencyUs / 1000.0};
+        auto passed {p99LatencyMs <= this->options.sloP99Ms and measurement.errorRate <= this->options.maxErrorRate};
+        fmt::print("[-] Offered: {:.1f} conn/s | TPS : {:.2f} req/s | p50: {:.2f} ms | p99: {:.2f} ms | Error: {:.2f}% "
+                   "| {}\r\n",
+                   rate, measurement.tps, measurement.p50LatencyUs / 1000.0, p99LatencyMs,
+                   measurement.errorRate * 100, passed ? "PASS" : "FAIL");
+        return passed;
+    }
+
+    std::optional<ClientRunner::Measurement> CapacitySearch::run()
+    {
+        std::optional<ClientRunner::Measurement> knee {};
+        ClientRunner::Measurement measurement {};
+
+        // Raise the rate until a step breaks the SLO or the error budget. The last step is clamped to the maximum rate,
+        // so the requested ceiling is always measured.
+        auto passingRate {0.0};
+        std::optional<double> failingRate {};
+        for (auto rate {this->options.startRate}; rate <= this->options.maxRate;)
+        {
+            if (!this->measureStep(rate, measurement))
+            {
+                failingRate = rate;
+                break;
+            }
+            passingRate = rate;
+            knee        = measurement;
+            if (rate == this->options.maxRate)
+                break;
+            rate = std::min(this->options.stepRate > 0 ? rate + this->options.stepRate : rate * 2,
+                            this->options.maxRate);
+        }
+
+        // Without a fixed step, bisect between the last passing rate and the first failing one
+        if (this->options.stepRate == 0 and failingRate)
+        {
+            while (*failingRate - passingRate > this->options.precision * *failingRate and *failingRate >= 1.0)
+            {
+                auto rate {(passingRate + *failingRate) / 2};
+                if (this->measureStep(rate, measurement))
+                {
+                    passingRate = rate;
+                    knee        = measurement;
+                }
+                else
+                    failingRate = rate;
+            }
+        }
+
+        return knee;
+    }
+} // namespace lily::net
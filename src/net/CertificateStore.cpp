@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <fmt/core.h>
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <spdlog/spdlog.h>
+
+#include <lily/net/CertificateStore.h>
+
+using namespace lily::core;
+
+namespace lily::net
+{
+    void CertificateStore::freeChain(STACK_OF(X509) * chain)
+    {
+        sk_X509_pop_free(chain, X509_free);
+    }
+
+    Expect<CertificateStore::Entry> CertificateStore::loadEntry(std::filesystem::path const& certificatePath)
+    {
+        Entry entry {certificatePath.stem().string()};
+
+        // Read the certificate, then the rest of its chain
+        std::unique_ptr<BIO, decltype(&BIO_free)> certificateBIO {BIO_new_file(certificatePath.c_str(), "r"),
+                                                                  BIO_free};
+        if (!certificateBIO)
+        {
+            spdlog::error("Lily-PQC server open certificate `{}` failed! Cause: BIO_new_file", certificatePath.string());
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+        entry.certificate.reset(PEM_read_bio_X509(certificateBIO.get(), nullptr, nullptr, nullptr));
+        if (!entry.certificate)
+        {
+            spdlog::error("Lily-PQC server read certificate `{}` failed! Cause: PEM_read_bio_X509",
+                          certificatePath.string());
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+        entry.chain.reset(sk_X509_new_null());
+        while (auto intermediate {PEM_read_bio_X509(certificateBIO.get(), nullptr, nullptr, nullptr)})
+            sk_X509_push(entry.chain.get(), intermediate);
+        ERR_clear_error();
+
+        // Read the private key next to the certificate
+        auto privateKeyPath {std::filesystem::path {certificatePath}.replace_extension(".key")};
+        std::unique_ptr<BIO, decltype(&BIO_free)> privateKeyBIO {BIO_new_file(privateKeyPath.c_str(), "r"), BIO_free};
+        if (!privateKeyBIO)
+        {
+            spdlog::error("Lily-PQC server open private key `{}` failed! Cause: BIO_new_file", privateKeyPath.string());
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+        entry.privateKey.reset(PEM_read_bio_PrivateKey(privateKeyBIO.get(), nullptr, nullptr, nullptr));
+        if (!entry.privateKey)
+        {
+            spdlog::error("Lily-PQC server read private key `{}` failed! Cause: PEM_read_bio_PrivateKey",
+                          privateKeyPath.string());
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+
+        // Check whether the private key and certificate match or not
+        if (X509_check_private_key(entry.certificate.get(), entry.privateKey.get()) <= 0)
+        {
+            spdlog::error("Lily-PQC server private key and certificate `{}` mismatch! Cause: X509_check_private_key",
+                          entry.name);
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+        return entry;
+    }
+
+    Expect<std::unique_ptr<CertificateStore>> CertificateStore::load(std::filesystem::path const& directory)
+    {
+        std::unique_ptr<CertificateStore> store {new CertificateStore {}};
+
+        // Every certificate must come with its private key
+        std::error_code ec {};
+        for (auto const& file: std::filesystem::directory_iterator {directory, ec})
+        {
+            if (!file.is_regular_file() or file.path().extension() != ".crt")
+                continue;
+            auto outcomeEntry {loadEntry(file.path())};
+            if (!outcomeEntry)
+                return outcomeEntry.error();
+            store->entries.emplace_back(std::move(outcomeEntry.assume_value()));
+        }
+        if (ec)
+        {
+            spdlog::error("Lily-PQC server read certificate directory failed! Why: {}", ec.message());
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+        if (store->entries.empty())
+        {
+            spdlog::error("Lily-PQC server certificate directory `{}` has no `<name>.crt` and `<name>.key` pair!",
+                          directory.string());
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+        std::ranges::sort(store->entries, {}, &Entry::name);
+
+        for (auto const& entry: store->entries)
+            fmt::print("[-] Certificate `{}` loaded ({})\r\n", entry.name,
+                       EVP_PKEY_get0_type_name(entry.privateKey.get()));
+        return store;
+    }
+
+    Expect<void> CertificateStore::attach(SSL_CTX* ctx) const
+    {
+        // The default pair is presented when the callback finds no better match
+        auto const& entry {this->entries.front()};
+        if (SSL_CTX_use_cert_and_key(ctx, entry.certificate.get(), entry.privateKey.get(), entry.chain.get(), 1) <= 0)
+        {
+            spdlog::error("Lily-PQC server context use default certificate failed! Cause: SSL_CTX_use_cert_and_key");
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+        SSL_CTX_set_cert_cb(ctx, onCertificate, const_cast<CertificateStore*>(this));
+        return success;
+    }
+
+    CertificateStore::Entry const& CertificateStore::select(SSL* ssl) const
+    {
+        // The SNI names the pair explicitly
+        if (auto serverName {SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name)})
+        {
+            auto entry {std::ranges::find(this->entries, std::string_view {serverName}, &Entry::name)};
+            if (entry != this->entries.end())
+                return *entry;
+        }
+
+        // Otherwise take the first pair the client can verify with its `signature_algorithms`
+        for (auto const& entry: this->entries)
+        {
+            if (SSL_check_chain(ssl, entry.certificate.get(), entry.privateKey.get(), entry.chain.get()) &
+                CERT_PKEY_VALID)
+                return entry;
+        }
+        return this->entries.front();
+    }
+
+    int CertificateStore::onCertificate(SSL* ssl, void* arg)
+    {
+        // The pooled `SSL` objects keep the pair of their previous connection, so the pair is always set
+        auto const& entry {static_cast<CertificateStore const*>(arg)->select(ssl)};
+        return SSL_use_cert_and_key(ssl, entry.certificate.get(), entry.privateKey.get(), entry.chain.get(), 1) == 1;
+    }
+} // namespace lily::net
@@ -1,92 +1,330 @@
+#include <boost/asio/experimental/awaitable_operators.hpp>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <deque>
+#include <functional>
+#include <optional>
 #include <spdlog/spdlog.h>
 
-#include <lily/core/Constants.h>
 #include <lily/log/ClientLog.h>
 #include <lily/net/ClientConnection.h>
+#include <lily/net/ConnectionTrace.h>
+#include <lily/net/DiscardBody.h>
+#include <lily/net/KtlsStream.h>
 
 using namespace lily::core;
 using namespace lily::log;
+using namespace boost::asio::experimental::awaitable_operators;
 
 namespace lily::net
 {
-    ClientConnection::ClientConnection():
-        ioc(std::make_unique<boost::beast::net::io_context>()), ctx {boost::asio::ssl::context::tlsv13_client}
+    /**
+     * @brief The requests of one connection whose write or response is still pending.
+     *
+     * The writer sends up to `depth` requests ahead of the responses, and the reader matches the responses with the
+     * requests in order. Both run on the `io_context` of the connection, so the state needs no lock.
+     */
+    struct Pipeline
     {
-    }
+        struct Request
+        {
+            std::chrono::high_resolution_clock::time_point beginWrite {};
+            std::chrono::high_resolution_clock::time_point endWrite {};
+            std::chrono::high_resolution_clock::time_point endRead {};
+            std::size_t writeSize {};
+            std::size_t readSize {};
 
-    ClientConnection::ClientConnection(ClientConnection&& other): ioc(std::move(other.ioc)), ctx(std::move(other.ctx))
-    {
-    }
+            // The size of the body drawn for the request
+            uint32_t payloadSize {};
+            bool written {};
+            bool read {};
+        };
 
-    ClientConnection& ClientConnection::operator=(ClientConnection&& other)
+        // Wakes the writer up when a response frees a slot of the pipeline
+        boost::asio::steady_timer slotReleased;
+        uint32_t depth;
+
+        // The number of requests to send, zero for unlimited
+        uint32_t total;
+
+        // The pending requests, the first one has the index `completedCount`
+        std::deque<Request> pending {};
+        uint64_t completedCount {};
+        uint64_t sentCount {};
+        uint64_t receivedCount {};
+
+        boost::beast::error_code writeEc {};
+        boost::beast::error_code readEc {};
+
+        std::function<void(Request const&, uint64_t)> onCompleted {};
+
+        Pipeline(boost::asio::any_io_executor executor, uint32_t depth, uint32_t total):
+            slotReleased {executor}, depth {depth}, total {total}
+        {
+        }
+
+        bool hasMore(uint64_t count) const
+        {
+            return this->total == 0 or count < this->total;
+        }
+
+        Request& at(uint64_t index)
+        {
+            return this->pending[index - this->completedCount];
+        }
+
+        // Report the requests whose write and response are both done, in order
+        void complete()
+        {
+            while (!this->pending.empty() and this->pending.front().written and this->pending.front().read)
+            {
+                this->onCompleted(this->pending.front(), this->completedCount++);
+                this->pending.pop_front();
+            }
+        }
+    };
+
+    // Abort the pending operations of the other side of the pipeline
+    template<class Stream>
+    static void cancel(Stream& stream, Pipeline& pipeline)
     {
-        this->ioc = std::move(other.ioc);
-        this->ctx = std::move(other.ctx);
-        return *this;
+        boost::beast::error_code ec {};
+        if constexpr (std::is_same_v<Stream, KtlsStream>)
+            std::ignore = stream.next_layer().cancel(ec);
+        else
+            boost::beast::get_lowest_layer(stream).cancel();
+        pipeline.slotReleased.cancel();
     }
 
-    Expect<void> ClientConnection::sendDummyData(std::string const& serverHost, uint16_t serverPort,
-                                                 std::string const& tlsGroup, uint32_t dummyDataLength)
+    template<class Stream>
+    static boost::asio::awaitable<void> writeRequests(Stream& stream, ClientSetup const& setup, Pipeline& pipeline,
+                                                      std::mt19937_64& generator)
     {
-        ClientConnection connection {};
-
-        // Variable that collect the error code thrown by boost function
-        boost::beast::error_code ec {};
+        // Each header is completed in this buffer, only allocated once per connection
+        std::string header {};
+        header.reserve(setup.keepAliveHeader.size() + setup.closeHeader.size());
 
-        // Disable the verification. The verification will only be necessary for mutual TLS.
-        std::ignore = connection.ctx.set_verify_mode(boost::asio::ssl::verify_none, ec);
-        if (ec)
+        while (pipeline.hasMore(pipeline.sentCount) and !pipeline.readEc)
         {
-            spdlog::error("Lily-PQC client context set_verify_mode failed! Why: {}", ec.message());
-            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+            // Wait for a free slot of the pipeline
+            if (pipeline.sentCount - pipeline.receivedCount >= pipeline.depth)
+            {
+                boost::beast::error_code ec {};
+                pipeline.slotReleased.expires_at(boost::asio::steady_timer::time_point::max());
+                co_await pipeline.slotReleased.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+                continue;
+            }
+
+            // The last request asks the server to close the connection
+            auto index {pipeline.sentCount++};
+            header.assign(pipeline.total != 0 and index + 1 == pipeline.total ? setup.closeHeader
+                                                                               : setup.keepAliveHeader);
+
+            // Send the serialized header followed by a slice of the shared payload pool
+            auto payloadSize {setup.payload->drawSize(generator)};
+            fmt::format_to(std::back_inserter(header), "Content-Length: {}\r\n\r\n", payloadSize);
+            std::array<boost::asio::const_buffer, 2> requestBuffers {boost::asio::buffer(header),
+                                                                     setup.payload->getSlice(payloadSize, generator)};
+            auto& pendingRequest {pipeline.pending.emplace_back()};
+            pendingRequest.beginWrite  = std::chrono::high_resolution_clock::now();
+            pendingRequest.payloadSize = payloadSize;
+            auto writeSize {co_await boost::asio::async_write(
+                stream, requestBuffers, boost::asio::redirect_error(boost::asio::use_awaitable, pipeline.writeEc))};
+            if (pipeline.writeEc)
+                co_return cancel(stream, pipeline);
+
+            auto& request {pipeline.at(index)};
+            request.endWrite  = std::chrono::high_resolution_clock::now();
+            request.writeSize = writeSize;
+            request.written   = true;
+            pipeline.complete();
         }
+    }
 
-        // Force the client to use TLS1.3
-        SSL_CTX_set_min_proto_version(connection.ctx.native_handle(), TLS1_3_VERSION);
-        SSL_CTX_set_max_proto_version(connection.ctx.native_handle(), TLS1_3_VERSION);
+    template<class Stream>
+    static boost::asio::awaitable<void> readResponses(Stream& stream, Pipeline& pipeline)
+    {
+        // This buffer is used for reading and must be persisted
+        boost::beast::flat_buffer buffer {};
 
-        // Set the key exchange algorithm
-        if (SSL_CTX_set1_groups_list(connection.ctx.native_handle(), tlsGroup.c_str()) <= 0)
+        while (pipeline.hasMore(pipeline.receivedCount) and !pipeline.writeEc)
         {
-            spdlog::error("Lily-PQC client context set key exchange algorithm failed! Cause: SSL_CTX_set1_groups_list");
-            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+            // The echoed body is only counted, so its size isn't limited
+            boost::beast::http::response_parser<DiscardBody> parser {};
+            parser.body_limit(std::numeric_limits<uint64_t>::max());
+
+            auto readSize {co_await boost::beast::http::async_read(
+                stream, buffer, parser, boost::asio::redirect_error(boost::asio::use_awaitable, pipeline.readEc))};
+            if (pipeline.readEc)
+                co_return cancel(stream, pipeline);
+
+            // The server can't answer a request before receiving it, so the request is already pending
+            auto& request {pipeline.at(pipeline.receivedCount++)};
+            request.endRead  = std::chrono::high_resolution_clock::now();
+            request.readSize = readSize;
+            request.read     = true;
+            pipeline.slotReleased.cancel();
+            pipeline.complete();
         }
+    }
+
+    // The position of the negotiated group in the colon-separated groups offered by the client, compared without
+    // case. Returns the count of the offered groups if not found.
+    static std::size_t getGroupIndex(std::string_view offered, std::string_view negotiated)
+    {
+        auto isSameName {[](std::string_view left, std::string_view right)
+                         {
+                             return std::ranges::equal(
+                                 left, right, [](unsigned char a, unsigned char b)
+                                 { return std::tolower(a) == std::tolower(b); });
+                         }};
 
-        // Set the supported signature algorithm
-        if (SSL_CTX_set1_sigalgs_list(connection.ctx.native_handle(), constants::SUPPORTED_SIGALGS_LIST) <= 0)
+        std::size_t index {};
+        for (std::size_t begin {}; begin <= offered.size(); ++index)
         {
-            spdlog::error(
-                "Lily-PQC client context set supported signature algorithm failed! Cause: SSL_CTX_set1_sigalgs_list");
-            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+            auto end {std::min(offered.find(':', begin), offered.size())};
+            if (isSameName(offered.substr(begin, end - begin), negotiated))
+                return index;
+            begin = end + 1;
         }
+        return index;
+    }
+
+    ClientConnection::ClientConnection(std::shared_ptr<ClientSetup> setup): setup(std::move(setup)) {}
+
+    ClientConnection::ClientConnection(ClientConnection&& other): setup(std::move(other.setup)) {}
+
+    ClientConnection& ClientConnection::operator=(ClientConnection&& other)
+    {
+        this->setup = std::move(other.setup);
+        return *this;
+    }
+
+    Expect<void> ClientConnection::sendDummyData(ClientOptions const& options, VirtualUser& user,
+                                                 std::shared_ptr<ClientSetup> setup,
+                                                 std::shared_ptr<PayloadPool const> payload, std::stop_token stopToken)
+    {
+        // Drive the coroutine on a private `io_context`, so the calling thread serves the whole connection
+        boost::asio::io_context ioc {1};
+        std::optional<Expect<void>> outcome {};
+        boost::asio::co_spawn(
+            ioc,
+            [&]() -> boost::asio::awaitable<void>
+            { outcome.emplace(co_await sendDummyDataAsync(options, user, std::move(setup), std::move(payload))); },
+            boost::asio::detached);
+
+        // A connection never closed by the server, or stalled, must not hold the stop of the run
+        std::stop_callback stopCallback {stopToken, [&ioc] { ioc.stop(); }};
+        ioc.run();
+        return outcome.value_or(ErrorCode::LILY_ERRORCODE_UNEXPECTED);
+    }
+
+    boost::asio::awaitable<Expect<void>> ClientConnection::sendDummyDataAsync(ClientOptions const& options,
+                                                                             VirtualUser& user,
+                                                                             std::shared_ptr<ClientSetup> setup,
+                                                                             std::shared_ptr<PayloadPool const> payload)
+    {
+        // Variable that collect the error code thrown by boost function
+        boost::beast::error_code ec {};
 
         // These objects perform our I/O
-        boost::asio::ip::tcp::resolver resolver {*connection.ioc.get()};
-        boost::asio::ssl::stream<boost::beast::tcp_stream> stream {*connection.ioc.get(), connection.ctx};
+        auto executor {co_await boost::asio::this_coro::executor};
+        boost::asio::ip::tcp::socket socket {executor};
 
-        // Look up the domain name
-        auto resolvedServer {resolver.resolve(serverHost, fmt::format("{}", serverPort), ec)};
-        if (ec)
+        // Without the setup shared by the run, pay for the lookup and the TLS context on this connection
+        if (!setup)
         {
-            spdlog::error("Lily-PQC client failed to resolve server! Why: {}", ec.message());
-            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+            // Look up the domain name
+            boost::asio::ip::tcp::resolver resolver {executor};
+            auto resolvedServer {co_await resolver.async_resolve(
+                options.serverHost, fmt::format("{}", options.serverPort),
+                boost::asio::redirect_error(boost::asio::use_awaitable, ec))};
+            if (ec)
+            {
+                spdlog::error("Lily-PQC client failed to resolve server! Why: {}", ec.message());
+                co_return ErrorCode::LILY_ERRORCODE_EXPECTED;
+            }
+
+            auto outcomeSetup {ClientSetup::create(options, std::move(resolvedServer), std::move(payload))};
+            if (!outcomeSetup)
+                co_return outcomeSetup.error();
+            setup = std::move(outcomeSetup.assume_value());
         }
+        ClientConnection connection {setup};
 
         // Make the connection on the IP address we get from a lookup
-        std::ignore = boost::beast::get_lowest_layer(stream).connect(resolvedServer, ec);
+        co_await boost::asio::async_connect(socket, setup->endpoints,
+                                            boost::asio::redirect_error(boost::asio::use_awaitable, ec));
         if (ec)
         {
             if (ec != boost::asio::error::connection_refused and ec != boost::beast::net::ssl::error::stream_truncated)
             {
                 spdlog::error("Lily-PQC client connection to server failed! Why: {}", ec.message());
-                return ErrorCode::LILY_ERRORCODE_EXPECTED;
+                co_return ErrorCode::LILY_ERRORCODE_EXPECTED;
+            }
+            co_return ErrorCode::LILY_ERRORCODE_UNEXPECTED;
+        }
+
+        // kTLS needs the `SSL` object to own the socket, the Asio stream keeps the record layer in user space. The
+        // context is shared by every user, each stream only creates its own `SSL` object from it.
+        if (options.ktls)
+        {
+            auto ssl {SSL_new(setup->ctx.native_handle())};
+            if (!ssl)
+            {
+                ec.assign(static_cast<int>(ERR_get_error()), boost::asio::error::get_ssl_category());
+                spdlog::error("Lily-PQC client SSL object creation failed! Why: {}", ec.message());
+                co_return ErrorCode::LILY_ERRORCODE_EXPECTED;
+            }
+            KtlsStream stream {std::move(socket), ssl};
+            co_return co_await connection.exchange(stream, options, user);
+        }
+        boost::asio::ssl::stream<boost::beast::tcp_stream> stream {boost::beast::tcp_stream {std::move(socket)},
+                                                                   setup->ctx};
+        co_return co_await connection.exchange(stream, options, user);
+    }
+
+    template<class Stream>
+    boost::asio::awaitable<Expect<void>> ClientConnection::exchange(Stream& stream, ClientOptions const& options,
+                                                                   VirtualUser& user)
+    {
+        // Variable that collect the error code thrown by boost function
+        boost::beast::error_code ec {};
+
+        // Offer the last session of this user to skip the full handshake
+        if (options.resumption != ResumptionMode::LILY_RESUMPTION_NONE and user.session)
+        {
+            if (SSL_set_session(stream.native_handle(), user.session.get()) <= 0)
+            {
+                spdlog::error("Lily-PQC client set session to resume failed! Cause: SSL_set_session");
+                co_return ErrorCode::LILY_ERRORCODE_EXPECTED;
             }
-            return ErrorCode::LILY_ERRORCODE_UNEXPECTED;
         }
 
-        // Perform the SSL handshake
+        // Name the certificate expected from the server
+        if (!options.serverName.empty() and
+            SSL_set_tlsext_host_name(stream.native_handle(), options.serverName.c_str()) <= 0)
+        {
+            spdlog::error("Lily-PQC client set SNI failed! Cause: SSL_set_tlsext_host_name");
+            co_return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+
+        // Perform the SSL handshake, the trace splits its duration between the handshake messages
         auto beginHandshakeTime {std::chrono::high_resolution_clock::now()};
-        std::ignore = stream.handshake(boost::asio::ssl::stream_base::client, ec);
+        HandshakePhases phases {};
+        HandshakeTraffic traffic {};
+        NegotiatedParameters parameters {};
+        ConnectionContext context {};
+        {
+            ConnectionTrace trace {stream.native_handle()};
+            co_await stream.async_handshake(boost::asio::ssl::stream_base::client,
+                                            boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+            phases     = trace.getPhases();
+            traffic    = trace.getTraffic();
+            parameters = trace.getParameters();
+            context    = trace.getContext();
+        }
         auto handshakeDuration {std::chrono::duration_cast<std::chrono::microseconds>(
                                     std::chrono::high_resolution_clock::now() - beginHandshakeTime)
                                     .count()};
@@ -96,63 +334,89 @@ namespace lily::net
                 ec != boost::asio::error::connection_reset)
             {
                 spdlog::error("Lily-PQC client SSL handshake with server failed! Why: {}", ec.message());
-                return ErrorCode::LILY_ERRORCODE_EXPECTED;
+                co_return ErrorCode::LILY_ERRORCODE_EXPECTED;
             }
-            return ErrorCode::LILY_ERRORCODE_UNEXPECTED;
-        }
-
-        // Set up an HTTP GET request message
-        boost::beast::http::request<boost::beast::http::string_body> req {boost::beast::http::verb::post, "/", 11};
-        req.set(boost::beast::http::field::host, serverHost);
-        req.set(boost::beast::http::field::user_agent, BOOST_BEAST_VERSION_STRING);
-        req.set(boost::beast::http::field::content_type, "text/plain");
-        req.keep_alive(false);
-
-        // Create dummy body with the given size
-        req.body().assign(dummyDataLength, 'A');
-        req.prepare_payload();
-
-        // Send the HTTP request to the remote host
-        auto beginWriteTime {std::chrono::high_resolution_clock::now()};
-        auto writeSize {boost::beast::http::write(stream, req, ec)};
-        auto writeDuration {std::chrono::duration_cast<std::chrono::microseconds>(
-                                std::chrono::high_resolution_clock::now() - beginWriteTime)
-                                .count()};
-        if (ec)
-        {
-            spdlog::error("Lily-PQC client SSL write to server failed! Why: {}", ec.message());
-            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+            co_return ErrorCode::LILY_ERRORCODE_UNEXPECTED;
         }
 
-        // This buffer is used for reading and must be persisted
-        boost::beast::flat_buffer buffer {};
+        // Log every request of the connection once both its write and its response are done. The handshake duration,
+        // its phases, its traffic and its primitive times are only logged with the first request.
+        auto resumed {SSL_session_reused(stream.native_handle()) == 1};
+        auto [ktlsSend, ktlsRecv] {KtlsStream::getOffload(stream)};
+        Pipeline pipeline {co_await boost::asio::this_coro::executor, std::max(options.pipelineDepth, 1u),
+                           options.requestsPerConnection};
+        pipeline.onCompleted = [&](Pipeline::Request const& request, uint64_t index)
+        {
+            // The read duration only covers the wait for the rest of the response once the request is sent
+            auto writeDuration {std::chrono::duration_cast<std::chrono::microseconds>(request.endWrite -
+                                                                                      request.beginWrite)
+                                    .count()};
+            auto readDuration {
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::max(request.endRead - request.endWrite, std::chrono::high_resolution_clock::duration {}))
+                    .count()};
+            // The first request waited for the connection, so its latency starts when the connection was due
+            auto latency {std::chrono::duration_cast<std::chrono::microseconds>(
+                              request.endRead - (index == 0 ? user.scheduledStart : request.beginWrite))
+                              .count()};
+            ClientLog::getInstance().write(index == 0 ? handshakeDuration : 0,
+                                           index == 0 ? phases : HandshakePhases {},
+                                           index == 0 ? traffic : HandshakeTraffic {}, request.writeSize,
+                                           writeDuration, request.readSize, readDuration, resumed, ktlsSend,
+                                           ktlsRecv, index, latency, request.payloadSize, parameters, context.id,
+                                           index == 0 ? context.primitives : PrimitiveTimes {});
+            if (user.histograms)
+            {
+                if (index == 0)
+                {
+                    user.histograms->handshake.record(handshakeDuration);
+                    user.histograms->recordHandshakeBytes(traffic.bytesSent, traffic.bytesReceived);
+                    user.histograms->recordGroup(getGroupIndex(options.tlsGroup, getLogName(parameters.group)),
+                                                 handshakeDuration, traffic);
+                }
+                user.histograms->write.record(writeDuration);
+                user.histograms->read.record(readDuration);
+                user.histograms->total.record(latency);
+            }
+            ++user.completedRequests;
+            if (user.successfulRequests)
+                user.successfulRequests->fetch_add(1, std::memory_order_relaxed);
+        };
 
-        // Declare a container to hold the response
-        boost::beast::http::response<boost::beast::http::dynamic_body> res {};
+        // Send the HTTP requests while receiving the HTTP responses. A server streaming the echo starts responding
+        // before the whole request is sent, so reading only afterwards could block both sides on large bodies.
+        co_await (writeRequests(stream, *this->setup, pipeline, user.generator) and readResponses(stream, pipeline));
 
-        // Receive the HTTP response
-        auto beginReadTime {std::chrono::high_resolution_clock::now()};
-        auto readSize {boost::beast::http::read(stream, buffer, res, ec)};
-        auto readDuration {std::chrono::duration_cast<std::chrono::microseconds>(
-                               std::chrono::high_resolution_clock::now() - beginReadTime)
-                               .count()};
-        if (ec)
+        // A side failing cancels the other one, so the first error is the one not aborted
+        if (pipeline.writeEc and pipeline.writeEc != boost::asio::error::operation_aborted)
+        {
+            spdlog::error("Lily-PQC client SSL write to server failed! Why: {}", pipeline.writeEc.message());
+            co_return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+        if (pipeline.readEc)
         {
-            spdlog::error("Lily-PQC client SSL read from server failed! Why: {}", ec.message());
-            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+            spdlog::error("Lily-PQC client SSL read from server failed! Why: {}", pipeline.readEc.message());
+            co_return ErrorCode::LILY_ERRORCODE_EXPECTED;
         }
 
-        // Log server SSL performance
-        ClientLog::getInstance().write(handshakeDuration, writeSize, writeDuration, readSize, readDuration);
+        // Keep the newest resumable session. TLS 1.3 tickets arrive after the handshake, so they have been processed
+        // once the responses are read.
+        if (options.resumption != ResumptionMode::LILY_RESUMPTION_NONE)
+        {
+            std::unique_ptr<SSL_SESSION, decltype(&SSL_SESSION_free)> session {SSL_get1_session(stream.native_handle()),
+                                                                              SSL_SESSION_free};
+            if (session and SSL_SESSION_is_resumable(session.get()))
+                user.session = std::move(session);
+        }
 
         // Gracefully close the stream
-        stream.shutdown(ec);
+        co_await stream.async_shutdown(boost::asio::redirect_error(boost::asio::use_awaitable, ec));
         if (ec and ec != boost::beast::net::ssl::error::stream_truncated)
         {
             spdlog::error("Lily-PQC client SSL shutdown to server failed! Why: {}", ec.message());
-            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+            co_return ErrorCode::LILY_ERRORCODE_EXPECTED;
         }
 
-        return success;
+        co_return success;
     }
 } // namespace lily::net
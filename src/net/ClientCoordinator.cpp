@@ -0,0 +1,254 @@
+#include <fmt/color.h>
+#include <fmt/core.h>
+#include <signal.h>
+#include <spdlog/spdlog.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+#include <lily/log/ClientLog.h>
+#include <lily/net/ClientCoordinator.h>
+#include <lily/net/ClientReport.h>
+#include <lily/net/ClientRunner.h>
+
+using namespace lily::core;
+using namespace lily::log;
+
+namespace lily::net
+{
+    // The messages sent by the coordinator, and the one sent by a worker once ready
+    enum class ChannelMessage : uint8_t
+    {
+        LILY_CHANNEL_READY,
+        LILY_CHANNEL_START,
+        LILY_CHANNEL_STOP
+    };
+
+    // The report sent by a worker each second: its counters, whether it stopped, then the latencies recorded since
+    // its previous report
+    static constexpr std::size_t REPORT_FINISHED_INDEX {4};
+    static constexpr std::size_t REPORT_HISTOGRAMS_INDEX {5};
+    static constexpr std::size_t REPORT_SIZE {REPORT_HISTOGRAMS_INDEX + RequestHistograms::SERIALIZED_SIZE};
+
+    // The time between two reports of a worker
+    static constexpr std::chrono::seconds WORKER_REPORT_INTERVAL {1};
+
+    ClientCoordinator::ClientCoordinator(ClientOptions const& options):
+        options(options), ioc(std::make_unique<boost::asio::io_context>(1))
+    {
+    }
+
+    ClientCoordinator::~ClientCoordinator()
+    {
+        this->terminate();
+    }
+
+    Expect<std::unique_ptr<ClientCoordinator>> ClientCoordinator::create(ClientOptions const& options)
+    {
+        std::unique_ptr<ClientCoordinator> coordinator {new ClientCoordinator {options}};
+
+        // Never more workers than users
+        auto processes {std::min(options.processes, options.concurrentUsers)};
+        for (uint32_t i {}; i < processes; ++i)
+        {
+            // Variable that collect the error code thrown by boost function
+            boost::system::error_code ec {};
+
+            boost::asio::local::stream_protocol::socket coordinatorEnd {*coordinator->ioc};
+            boost::asio::local::stream_protocol::socket workerEnd {*coordinator->ioc};
+            std::ignore = boost::asio::local::connect_pair(coordinatorEnd, workerEnd, ec);
+            if (ec)
+            {
+                spdlog::error("Lily-PQC client coordinator failed to create worker channel! Why: {}", ec.message());
+                return ErrorCode::LILY_ERRORCODE_EXPECTED;
+            }
+
+            // Each worker gets its share of the users and of the rate, the coordinator bounds the run
+            auto workerOptions {options};
+            workerOptions.concurrentUsers =
+                options.concurrentUsers / processes + (i < options.concurrentUsers % processes);
+            workerOptions.rate            = options.rate / processes;
+            workerOptions.durationSeconds = 0;
+            workerOptions.totalRequests   = 0;
+            workerOptions.processes       = 1;
+
+            auto pid {fork()};
+            if (pid < 0)
+            {
+                spdlog::error("Lily-PQC client coordinator failed to start worker! Cause: fork");
+                return ErrorCode::LILY_ERRORCODE_EXPECTED;
+            }
+            if (pid == 0)
+            {
+                // The worker only keeps its own end of its channel
+                coordinatorEnd.close(ec);
+                for (auto& worker: coordinator->workers)
+                    worker.channel.close(ec);
+                coordinator->workers.clear();
+                runWorker(std::move(workerEnd), workerOptions, i);
+            }
+            coordinator->workers.push_back({pid, std::move(coordinatorEnd)});
+        }
+
+        // Wait until every worker resolved the server and built its setup
+        for (auto& worker: coordinator->workers)
+        {
+            // Variable that collect the error code thrown by boost function
+            boost::system::error_code ec {};
+
+            ChannelMessage message {};
+            std::ignore = boost::asio::read(worker.channel, boost::asio::buffer(&message, sizeof(message)), ec);
+            if (ec or message != ChannelMessage::LILY_CHANNEL_READY)
+            {
+                spdlog::error("Lily-PQC client worker failed to start! Why: {}",
+                              ec ? ec.message() : "Unexpected message");
+                return ErrorCode::LILY_ERRORCODE_EXPECTED;
+            }
+        }
+        return coordinator;
+    }
+
+    void ClientCoordinator::runWorker(boost::asio::local::stream_protocol::socket&& channel,
+                                      ClientOptions const& options, uint32_t index)
+    {
+        // Variable that collect the error code thrown by boost function
+        boost::system::error_code ec {};
+
+        // The watcher of the coordinator isn't forked, each worker flushes its own log on shutdown
+        watchShutdownSignals();
+
+        // Each worker logs its requests in its own file
+        ClientLog::setFileTag(fmt::format("_worker{}", index));
+        auto outcomeRunner {ClientRunner::create(options)};
+        if (!outcomeRunner)
+            std::exit(EXIT_FAILURE);
+        auto& runner {*outcomeRunner.assume_value()};
+
+        // Start with the other workers
+        auto message {ChannelMessage::LILY_CHANNEL_READY};
+        std::ignore = boost::asio::write(channel, boost::asio::buffer(&message, sizeof(message)), ec);
+        std::ignore = boost::asio::read(channel, boost::asio::buffer(&message, sizeof(message)), ec);
+        if (ec or message != ChannelMessage::LILY_CHANNEL_START)
+            std::exit(EXIT_FAILURE);
+        runner.start();
+
+        auto histograms {std::make_unique<RequestHistograms>()};
+        std::vector<uint64_t> report(REPORT_SIZE);
+        while (true)
+        {
+            std::this_thread::sleep_for(WORKER_REPORT_INTERVAL);
+
+            // The only message expected once started is the stop
+            auto stopping {channel.available(ec) > 0 or ec};
+            if (stopping)
+                runner.stop();
+
+            auto counters {runner.getCounters()};
+            runner.drainHistograms(*histograms);
+            report[0]                     = counters.successfulRequest;
+            report[1]                     = counters.failedRequest;
+            report[2]                     = counters.lateArrival;
+            report[3]                     = counters.droppedArrival;
+            report[REPORT_FINISHED_INDEX] = stopping;
+            histograms->serialize(
+                std::span {report}.subspan<REPORT_HISTOGRAMS_INDEX, RequestHistograms::SERIALIZED_SIZE>());
+            histograms->reset();
+
+            std::ignore = boost::asio::write(channel, boost::asio::buffer(report), ec);
+            if (ec or stopping)
+            {
+                runner.stop();
+                std::exit(ec ? EXIT_FAILURE : EXIT_SUCCESS);
+            }
+        }
+    }
+
+    void ClientCoordinator::run()
+    {
+        // Start every worker at the same moment
+        for (auto& worker: this->workers)
+        {
+            // Variable that collect the error code thrown by boost function
+            boost::system::error_code ec {};
+
+            auto message {ChannelMessage::LILY_CHANNEL_START};
+            std::ignore = boost::asio::write(worker.channel, boost::asio::buffer(&message, sizeof(message)), ec);
+        }
+        fmt::print(fmt::fg(fmt::color::green), "[v] All users is active and testing the server! ({} processes)\r\n",
+                   this->workers.size());
+
+        // The reports of the workers arrive together each second, so they are read in turn
+        ClientReport report {this->options};
+        std::vector<ClientCounters> workerCounters(this->workers.size());
+        std::vector<bool> finished(this->workers.size());
+        std::vector<uint64_t> workerReport(REPORT_SIZE);
+        auto stopping {false};
+        ClientCounters counters {};
+        while (std::find(finished.begin(), finished.end(), false) != finished.end())
+        {
+            for (std::size_t i {}; i < this->workers.size(); ++i)
+            {
+                if (finished[i])
+                    continue;
+
+                // Variable that collect the error code thrown by boost function
+                boost::system::error_code ec {};
+
+                // A worker which died keeps its last counters
+                std::ignore = boost::asio::read(this->workers[i].channel, boost::asio::buffer(workerReport), ec);
+                if (ec)
+                {
+                    spdlog::error("Lily-PQC client worker {} stopped reporting! Why: {}", i, ec.message());
+                    finished[i] = true;
+                    continue;
+                }
+                workerCounters[i] = {static_cast<int64_t>(workerReport[0]), static_cast<int64_t>(workerReport[1]),
+                                     static_cast<int64_t>(workerReport[2]), static_cast<int64_t>(workerReport[3])};
+                finished[i]       = workerReport[REPORT_FINISHED_INDEX] != 0;
+                report.getInterval().addSerialized(
+                    std::span<uint64_t const> {workerReport}
+                        .subspan<REPORT_HISTOGRAMS_INDEX, RequestHistograms::SERIALIZED_SIZE>());
+            }
+
+            counters = {};
+            for (auto const& workerCounter: workerCounters)
+                counters += workerCounter;
+
+            // Stop every worker once the run is over, their last reports are still collected
+            if (!stopping and report.isFinished(counters))
+            {
+                stopping = true;
+                for (auto& worker: this->workers)
+                {
+                    // Variable that collect the error code thrown by boost function
+                    boost::system::error_code ec {};
+
+                    auto message {ChannelMessage::LILY_CHANNEL_STOP};
+                    std::ignore =
+                        boost::asio::write(worker.channel, boost::asio::buffer(&message, sizeof(message)), ec);
+                }
+            }
+            if (!stopping and report.isReportDue())
+                report.report(counters);
+        }
+
+        this->terminate();
+        report.report(counters);
+        report.writeResult(counters);
+    }
+
+    void ClientCoordinator::terminate()
+    {
+        for (auto& worker: this->workers)
+        {
+            // Variable that collect the error code thrown by boost function
+            boost::system::error_code ec {};
+
+            // Closing the channel makes a blocked worker fail, the signal covers the ones still busy
+            worker.channel.close(ec);
+            kill(worker.pid, SIGTERM);
+            waitpid(worker.pid, nullptr, 0);
+        }
+        this->workers.clear();
+    }
+} // namespace lily::net
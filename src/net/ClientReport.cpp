@@ -0,0 +1,161 @@
+#include <array>
+#include <fmt/chrono.h>
+#include <fmt/color.h>
+#include <fmt/core.h>
+#include <fstream>
+#include <spdlog/spdlog.h>
+
+#include <lily/net/ClientReport.h>
+
+namespace lily::net
+{
+    // The time between two periodic reports
+    static constexpr std::chrono::seconds REPORT_INTERVAL {5};
+
+    // The percentiles printed and saved for each latency
+    static constexpr std::array PERCENTILES {50.0, 90.0, 99.0, 99.9};
+
+    // Print the interval and cumulative percentiles of one latency, in ms
+    static void printPercentiles(std::string_view name, log::LatencyHistogram const& interval,
+                                 log::LatencyHistogram const& cumulative)
+    {
+        std::string line {fmt::format("[-] {} Latency", name)};
+        for (auto percentile: PERCENTILES)
+            line += fmt::format(" | p{}: {:.2f}/{:.2f} ms", percentile, interval.getPercentile(percentile) / 1000.0,
+                                cumulative.getPercentile(percentile) / 1000.0);
+        fmt::print("{}\r\n", line);
+    }
+
+    // Format the statistics of one latency as a JSON object, in µs
+    static std::string formatLatency(log::LatencyHistogram const& histogram)
+    {
+        std::string json {fmt::format(R"({{"count": {}, "mean": {:.2f}, "max": {})", histogram.getCount(),
+                                      histogram.getMean(), histogram.getMax())};
+        for (auto percentile: PERCENTILES)
+            json += fmt::format(R"(, "p{}": {})", percentile, histogram.getPercentile(percentile));
+        return json + "}";
+    }
+
+    // Print the handshakes of each offered group and format them as a JSON array, the groups never negotiated are
+    // left out
+    static std::string formatGroups(std::string_view offered, log::RequestHistograms const& histograms)
+    {
+        std::string json {};
+        std::size_t group {};
+        for (std::size_t begin {}; begin < offered.size() and group < log::RequestHistograms::MAX_GROUP_COUNT; ++group)
+        {
+            auto end {std::min(offered.find(':', begin), offered.size())};
+            auto name {offered.substr(begin, end - begin)};
+            begin = end + 1;
+
+            auto const& totals {histograms.groups[group]};
+            auto handshakes {totals.totals[log::GroupTotals::LILY_GROUP_HANDSHAKES].load(std::memory_order_relaxed)};
+            if (handshakes == 0)
+                continue;
+
+            fmt::print("[-] Group {} | Handshake: {} | Mean Handshake: {:.2f} ms | Mean Handshake Bytes Sent/Received: "
+                       "{:.0f}/{:.0f} | Mean Handshake Records Sent/Received: {:.1f}/{:.1f}\r\n",
+                       name, handshakes, totals.getMean(log::GroupTotals::LILY_GROUP_HANDSHAKE_US) / 1000.0,
+                       totals.getMean(log::GroupTotals::LILY_GROUP_BYTES_SENT),
+                       totals.getMean(log::GroupTotals::LILY_GROUP_BYTES_RECEIVED),
+                       totals.getMean(log::GroupTotals::LILY_GROUP_RECORDS_SENT),
+                       totals.getMean(log::GroupTotals::LILY_GROUP_RECORDS_RECEIVED));
+            json += fmt::format(
+                R"({}{{"name": "{}", "handshakes": {}, "mean_handshake_us": {:.2f}, )"
+                R"("mean_handshake_bytes_sent": {:.2f}, "mean_handshake_bytes_received": {:.2f}, )"
+                R"("mean_handshake_records_sent": {:.2f}, "mean_handshake_records_received": {:.2f}}})",
+                json.empty() ? "" : ", ", name, handshakes, totals.getMean(log::GroupTotals::LILY_GROUP_HANDSHAKE_US),
+                totals.getMean(log::GroupTotals::LILY_GROUP_BYTES_SENT),
+                totals.getMean(log::GroupTotals::LILY_GROUP_BYTES_RECEIVED),
+                totals.getMean(log::GroupTotals::LILY_GROUP_RECORDS_SENT),
+                totals.getMean(log::GroupTotals::LILY_GROUP_RECORDS_RECEIVED));
+        }
+        return "[" + json + "]";
+    }
+
+    ClientCounters& ClientCounters::operator+=(ClientCounters const& other)
+    {
+        this->successfulRequest += other.successfulRequest;
+        this->failedRequest += other.failedRequest;
+        this->lateArrival += other.lateArrival;
+        this->droppedArrival += other.droppedArrival;
+        return *this;
+    }
+
+    ClientReport::ClientReport(ClientOptions const& options):
+        options(options), interval(std::make_unique<log::RequestHistograms>()),
+        cumulative(std::make_unique<log::RequestHistograms>()), startTime(std::chrono::steady_clock::now()),
+        lastReportTime(startTime)
+    {
+    }
+
+    bool ClientReport::isFinished(ClientCounters const& counters) const
+    {
+        auto requestCount {counters.successfulRequest + counters.failedRequest};
+        return (this->options.durationSeconds != 0 and std::chrono::steady_clock::now() - this->startTime >=
+                                                           std::chrono::seconds {this->options.durationSeconds}) or
+               (this->options.totalRequests != 0 and static_cast<uint64_t>(requestCount) >= this->options.totalRequests);
+    }
+
+    bool ClientReport::isReportDue() const
+    {
+        return std::chrono::steady_clock::now() - this->lastReportTime >= REPORT_INTERVAL;
+    }
+
+    void ClientReport::report(ClientCounters const& counters)
+    {
+        this->cumulative->add(*this->interval);
+
+        auto now {std::chrono::steady_clock::now()};
+        auto successfulRequest {counters.successfulRequest};
+        auto elapsedTime {std::chrono::duration<double> {now - this->startTime}.count()};
+        auto intervalTime {std::chrono::duration<double> {now - this->lastReportTime}.count()};
+        fmt::print("[-] Successful Request: {} | Failed Request: {} | TPS : {:.2f} req/s | Interval TPS : {:.2f} "
+                   "req/s\r\n",
+                   counters.successfulRequest, counters.failedRequest, successfulRequest / elapsedTime,
+                   (successfulRequest - this->lastSuccessfulRequest) / intervalTime);
+        if (this->options.rate > 0)
+            fmt::print("[-] Late Arrival: {} | Dropped Arrival: {}\r\n", counters.lateArrival, counters.droppedArrival);
+        printPercentiles("Handshake", this->interval->handshake, this->cumulative->handshake);
+        printPercentiles("Write", this->interval->write, this->cumulative->write);
+        printPercentiles("Read", this->interval->read, this->cumulative->read);
+        printPercentiles("Total", this->interval->total, this->cumulative->total);
+
+        this->interval->reset();
+        this->lastReportTime        = now;
+        this->lastSuccessfulRequest = successfulRequest;
+    }
+
+    void ClientReport::writeResult(ClientCounters const& counters)
+    {
+        auto elapsedTime {
+            std::chrono::duration<double> {std::chrono::steady_clock::now() - this->startTime}.count()};
+        fmt::print(fmt::fg(fmt::color::green),
+                   "[v] Run finished after {:.1f} s | Successful Request: {} | Failed Request: {} | TPS : {:.2f} "
+                   "req/s\r\n",
+                   elapsedTime, counters.successfulRequest, counters.failedRequest,
+                   counters.successfulRequest / elapsedTime);
+        auto groups {formatGroups(this->options.tlsGroup, *this->cumulative)};
+
+        auto fileName {fmt::format("{:%F_%T}_result_client.json", fmt::localtime(std::time(nullptr)))};
+        std::ofstream stream {fileName};
+        if (!stream.is_open())
+        {
+            spdlog::error("Failed to create client result file");
+            return;
+        }
+        stream << fmt::format(
+            R"({{"tls_group": "{}", "sigalgs": "{}", "concurrent_users": {}, "data_length": {}, "rate": {}, )"
+            R"("duration_s": {:.3f}, "successful_requests": {}, "failed_requests": {}, "tps": {:.2f}, )"
+            R"("late_arrivals": {}, "dropped_arrivals": {}, "latency_us": {{"handshake": {}, "write": {}, )"
+            R"("read": {}, "total": {}}}, "groups": {}}})"
+            "\n",
+            this->options.tlsGroup, this->options.sigalgs, this->options.concurrentUsers,
+            this->options.dummyDataLength, this->options.rate, elapsedTime, counters.successfulRequest,
+            counters.failedRequest, counters.successfulRequest / elapsedTime, counters.lateArrival,
+            counters.droppedArrival, formatLatency(this->cumulative->handshake),
+            formatLatency(this->cumulative->write), formatLatency(this->cumulative->read),
+            formatLatency(this->cumulative->total), groups);
+        fmt::print(fmt::fg(fmt::color::green), "[v] Result saved to `{}`\r\n", fileName);
+    }
+} // namespace lily::net
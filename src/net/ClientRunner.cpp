@@ -0,0 +1,340 @@
+#include <algorithm>
+#include <deque>
+#include <fmt/color.h>
+#include <fmt/core.h>
+#include <random>
+
+#include <lily/crypto/PrimitiveHook.h>
+#include <lily/log/ClientLog.h>
+#include <lily/log/PrimitiveLog.h>
+#include <lily/net/ClientConnection.h>
+#include <lily/net/ClientRunner.h>
+
+using namespace lily::core;
+
+namespace lily::net
+{
+    // An arrival starting later than this is counted as late
+    static constexpr std::chrono::milliseconds LATE_ARRIVAL_THRESHOLD {1};
+
+    struct ClientRunner::ArrivalQueue
+    {
+        std::vector<VirtualUser> users;
+        std::vector<VirtualUser*> idleUsers {};
+
+        // The scheduled start of the arrivals waiting for an idle user, at most one per user
+        std::deque<std::chrono::steady_clock::time_point> pending {};
+    };
+
+    ClientRunner::ClientRunner(ClientOptions const& options, std::shared_ptr<ClientSetup> setup,
+                               std::shared_ptr<PayloadPool const> payload):
+        options(options), setup(std::move(setup)), payload(std::move(payload))
+    {
+    }
+
+    Expect<std::unique_ptr<ClientRunner>> ClientRunner::create(ClientOptions const& options)
+    {
+        log::ClientLog::setFormat(options.logFormat);
+        log::ClientLog::setOverflow(options.logOverflow);
+
+        // Log the primitives run by the handshakes next to the requests
+        log::PrimitiveLog::setFilePrefix(log::ClientLog::getFilePrefix());
+        log::PrimitiveLog::setFormat(options.logFormat);
+        log::PrimitiveLog::setOverflow(options.logOverflow);
+        crypto::installPrimitiveHook();
+
+        // Fill the payload pool once, it is the largest part of the setup and isn't part of the connection cost
+        auto outcomePayload {PayloadPool::create(options)};
+        if (!outcomePayload)
+            return outcomePayload.error();
+        auto payload {std::make_shared<PayloadPool const>(std::move(outcomePayload.assume_value()))};
+
+        // Each connection builds its own setup
+        if (options.coldSetup)
+            return std::unique_ptr<ClientRunner> {new ClientRunner {options, nullptr, std::move(payload)}};
+
+        auto outcomeEndpoints {ClientSetup::resolve(options)};
+        if (!outcomeEndpoints)
+            return outcomeEndpoints.error();
+        auto outcomeSetup {ClientSetup::create(options, std::move(outcomeEndpoints.assume_value()), payload)};
+        if (!outcomeSetup)
+            return outcomeSetup.error();
+        return std::unique_ptr<ClientRunner> {
+            new ClientRunner {options, std::move(outcomeSetup.assume_value()), std::move(payload)}};
+    }
+
+    log::RequestHistograms* ClientRunner::addThreadHistograms()
+    {
+        std::lock_guard lock {this->histogramsMtx};
+        return this->threadHistograms.emplace_back(std::make_unique<log::RequestHistograms>()).get();
+    }
+
+    void ClientRunner::drainHistograms(log::RequestHistograms& target)
+    {
+        std::lock_guard lock {this->histogramsMtx};
+        for (auto& histograms: this->threadHistograms)
+            histograms->drainInto(target);
+    }
+
+    ClientCounters ClientRunner::getCounters() const
+    {
+        return {this->totalSuccessfulRequest.load(), this->totalFailedRequest.load(), this->totalLateArrival.load(),
+                this->totalDroppedArrival.load()};
+    }
+
+    void ClientRunner::start()
+    {
+        if (this->options.threads == 0 and this->options.rate == 0)
+            this->workers = this->spawnThreadPerUser();
+        else
+        {
+            this->contexts = this->spawnAsync();
+            this->workers  = runContexts(this->contexts);
+        }
+    }
+
+    void ClientRunner::stop()
+    {
+        // The connections still in flight are abandoned, the thread-per-user ones by stopping their private context.
+        // The workers are joined before their contexts are destroyed.
+        for (auto& ioc: this->contexts)
+            ioc->stop();
+        for (auto& worker: this->workers)
+            worker.request_stop();
+        this->workers.clear();
+        this->contexts.clear();
+    }
+
+    void ClientRunner::run()
+    {
+        this->start();
+        fmt::print(fmt::fg(fmt::color::green), "[v] All users is active and testing the server!\r\n");
+
+        // The histograms are merged from every thread at each interval
+        ClientReport report {this->options};
+        while (true)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds {100});
+
+            auto counters {this->getCounters()};
+            auto finished {report.isFinished(counters)};
+            if (!finished and !report.isReportDue())
+                continue;
+
+            this->drainHistograms(report.getInterval());
+            report.report(counters);
+            if (finished)
+                break;
+        }
+
+        this->stop();
+        report.writeResult(this->getCounters());
+        log::PrimitiveLog::getInstance().report();
+    }
+
+    std::vector<std::jthread> ClientRunner::spawnThreadPerUser()
+    {
+        // Set-up concurrent users pool
+        std::vector<std::jthread> userThreads(this->options.concurrentUsers);
+        for (auto& thread: userThreads)
+            thread = std::jthread {
+                [this, histograms {this->addThreadHistograms()}](std::stop_token stopToken)
+                {
+                    // The state kept by this user between its requests
+                    VirtualUser user {};
+                    user.histograms         = histograms;
+                    user.successfulRequests = &this->totalSuccessfulRequest;
+
+                    // Send dummy data repeatedly, a failed connection counts as one failed request
+                    while (!stopToken.stop_requested())
+                    {
+                        user.scheduledStart = std::chrono::high_resolution_clock::now();
+                        auto outcome {ClientConnection::sendDummyData(this->options, user, this->setup, this->payload,
+                                                                      stopToken)};
+                        if (!outcome and !stopToken.stop_requested())
+                            ++this->totalFailedRequest;
+                    }
+                }};
+        return userThreads;
+    }
+
+    std::vector<std::unique_ptr<boost::asio::io_context>> ClientRunner::spawnAsync()
+    {
+        // The open loop runs on every core unless told otherwise, never with more threads than users
+        auto threads {this->options.threads != 0 ? this->options.threads : std::thread::hardware_concurrency()};
+        threads = std::clamp(threads, 1u, this->options.concurrentUsers);
+
+        // One single-threaded `io_context` per thread, so the users of a thread never contend with the other ones
+        std::vector<std::unique_ptr<boost::asio::io_context>> contexts(threads);
+        for (auto& ioc: contexts)
+            ioc = std::make_unique<boost::asio::io_context>(1);
+
+        // Each context records in its own histograms
+        std::vector<log::RequestHistograms*> histograms(threads);
+        for (auto& contextHistograms: histograms)
+            contextHistograms = this->addThreadHistograms();
+
+        // Spread the users round-robin over the contexts. In open loop, each context gets its share of the rate and
+        // of the users.
+        if (this->options.rate > 0)
+        {
+            for (uint32_t i {}; i < threads; ++i)
+                boost::asio::co_spawn(*contexts[i],
+                                      this->scheduleArrivals(this->options.rate / threads,
+                                                             this->options.concurrentUsers / threads +
+                                                                 (i < this->options.concurrentUsers % threads),
+                                                             histograms[i]),
+                                      boost::asio::detached);
+        }
+        else
+        {
+            for (uint32_t i {}; i < this->options.concurrentUsers; ++i)
+                boost::asio::co_spawn(*contexts[i % threads], this->runUserAsync(histograms[i % threads]),
+                                      boost::asio::detached);
+        }
+        return contexts;
+    }
+
+    std::vector<std::jthread> ClientRunner::runContexts(std::vector<std::unique_ptr<boost::asio::io_context>>& contexts)
+    {
+        std::vector<std::jthread> workers(contexts.size());
+        for (std::size_t i {}; i < workers.size(); ++i)
+            workers[i] = std::jthread {[ioc {contexts[i].get()}] { ioc->run(); }};
+        return workers;
+    }
+
+    ClientRunner::Measurement ClientRunner::measure(double rate, std::chrono::seconds warmUp,
+                                                    std::chrono::seconds window)
+    {
+        this->options.rate = rate;
+        this->start();
+
+        // Only measure once warmed up
+        auto histograms {std::make_unique<log::RequestHistograms>()};
+        std::this_thread::sleep_for(warmUp);
+        this->drainHistograms(*histograms);
+        histograms->reset();
+        auto successful {this->totalSuccessfulRequest.load()};
+        auto failed {this->totalFailedRequest.load()};
+        auto dropped {this->totalDroppedArrival.load()};
+        std::this_thread::sleep_for(window);
+        successful = this->totalSuccessfulRequest.load() - successful;
+        failed     = this->totalFailedRequest.load() - failed;
+        dropped    = this->totalDroppedArrival.load() - dropped;
+        this->drainHistograms(*histograms);
+
+        Measurement measurement {};
+        measurement.offeredRate    = rate;
+        measurement.tps            = static_cast<double>(successful) / window.count();
+        measurement.errorRate      = successful + failed + dropped == 0
+                                         ? 0.0
+                                         : static_cast<double>(failed + dropped) / (successful + failed + dropped);
+        measurement.p50LatencyUs   = histograms->total.getPercentile(50);
+        measurement.p99LatencyUs   = histograms->total.getPercentile(99);
+        measurement.p50HandshakeUs = histograms->handshake.getPercentile(50);
+        measurement.p99HandshakeUs = histograms->handshake.getPercentile(99);
+        if (auto handshakes {histograms->handshake.getCount()}; handshakes != 0)
+        {
+            auto const& sent {histograms->handshakeBytesSent};
+            auto const& received {histograms->handshakeBytesReceived};
+            measurement.handshakeBytesSent     = static_cast<double>(sent.load()) / handshakes;
+            measurement.handshakeBytesReceived = static_cast<double>(received.load()) / handshakes;
+        }
+
+        this->stop();
+        std::lock_guard lock {this->histogramsMtx};
+        this->threadHistograms.clear();
+        return measurement;
+    }
+
+    boost::asio::awaitable<void> ClientRunner::runUserAsync(log::RequestHistograms* histograms)
+    {
+        // The state kept by this user between its requests
+        VirtualUser user {};
+        user.histograms         = histograms;
+        user.successfulRequests = &this->totalSuccessfulRequest;
+
+        // Send dummy data repeatedly, a failed connection counts as one failed request
+        while (true)
+        {
+            user.scheduledStart = std::chrono::high_resolution_clock::now();
+            auto outcome {
+                co_await ClientConnection::sendDummyDataAsync(this->options, user, this->setup, this->payload)};
+            if (!outcome)
+                ++this->totalFailedRequest;
+        }
+    }
+
+    boost::asio::awaitable<void> ClientRunner::scheduleArrivals(double rate, uint32_t users,
+                                                                log::RequestHistograms* histograms)
+    {
+        ArrivalQueue queue {std::vector<VirtualUser>(users)};
+        for (auto& user: queue.users)
+        {
+            user.histograms         = histograms;
+            user.successfulRequests = &this->totalSuccessfulRequest;
+            queue.idleUsers.push_back(&user);
+        }
+
+        // The gap between two arrivals, either constant or drawn from the exponential distribution of a Poisson
+        // process with the same mean
+        std::mt19937_64 generator {std::random_device {}()};
+        std::exponential_distribution<double> poissonGap {rate};
+        auto nextGap {[&]
+                      {
+                          auto gap {this->options.arrival == ArrivalMode::LILY_ARRIVAL_POISSON ? poissonGap(generator)
+                                                                                               : 1.0 / rate};
+                          return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                              std::chrono::duration<double> {gap});
+                      }};
+
+        // The schedule only depends on the clock, so the arrivals missed while the thread was busy are caught up
+        boost::asio::steady_timer timer {co_await boost::asio::this_coro::executor};
+        auto scheduledStart {std::chrono::steady_clock::now()};
+        while (true)
+        {
+            scheduledStart += nextGap();
+            timer.expires_at(scheduledStart);
+            co_await timer.async_wait(boost::asio::use_awaitable);
+
+            // Start the connection on an idle user, otherwise keep it until a user is done
+            if (!queue.idleUsers.empty())
+            {
+                auto& user {*queue.idleUsers.back()};
+                queue.idleUsers.pop_back();
+                boost::asio::co_spawn(co_await boost::asio::this_coro::executor,
+                                      this->serveArrivals(queue, user, scheduledStart), boost::asio::detached);
+            }
+            else if (queue.pending.size() < queue.users.size())
+                queue.pending.push_back(scheduledStart);
+            else
+                ++this->totalDroppedArrival;
+        }
+    }
+
+    boost::asio::awaitable<void> ClientRunner::serveArrivals(ArrivalQueue& queue, VirtualUser& user,
+                                                             std::chrono::steady_clock::time_point scheduledStart)
+    {
+        while (true)
+        {
+            // Measure the latency from the scheduled start, including the time spent waiting for this user
+            auto delay {std::chrono::steady_clock::now() - scheduledStart};
+            if (delay > LATE_ARRIVAL_THRESHOLD)
+                ++this->totalLateArrival;
+            user.scheduledStart = std::chrono::high_resolution_clock::now() -
+                                  std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(delay);
+
+            auto outcome {
+                co_await ClientConnection::sendDummyDataAsync(this->options, user, this->setup, this->payload)};
+            if (!outcome)
+                ++this->totalFailedRequest;
+
+            // Serve the oldest pending arrival, or go back to the idle users
+            if (queue.pending.empty())
+                break;
+            scheduledStart = queue.pending.front();
+            queue.pending.pop_front();
+        }
+        queue.idleUsers.push_back(&user);
+    }
+} // namespace lily::net
@@ -0,0 +1,96 @@
+#include <boost/beast.hpp>
+#include <fmt/core.h>
+#include <sstream>
+#include <spdlog/spdlog.h>
+
+#include <lily/core/Constants.h>
+#include <lily/net/ClientSetup.h>
+
+using namespace lily::core;
+
+namespace lily::net
+{
+    ClientSetup::ClientSetup(std::shared_ptr<PayloadPool const> payload):
+        ctx {boost::asio::ssl::context::tlsv13_client}, payload {std::move(payload)}
+    {
+    }
+
+    Expect<boost::asio::ip::tcp::resolver::results_type> ClientSetup::resolve(ClientOptions const& options)
+    {
+        // Variable that collect the error code thrown by boost function
+        boost::beast::error_code ec {};
+
+        // Look up the domain name
+        boost::asio::io_context ioc {1};
+        boost::asio::ip::tcp::resolver resolver {ioc};
+        auto resolvedServer {resolver.resolve(options.serverHost, fmt::format("{}", options.serverPort), ec)};
+        if (ec)
+        {
+            spdlog::error("Lily-PQC client failed to resolve server! Why: {}", ec.message());
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+        return resolvedServer;
+    }
+
+    Expect<std::shared_ptr<ClientSetup>>
+        ClientSetup::create(ClientOptions const& options, boost::asio::ip::tcp::resolver::results_type endpoints,
+                            std::shared_ptr<PayloadPool const> payload)
+    {
+        std::shared_ptr<ClientSetup> setup {new ClientSetup {std::move(payload)}};
+        setup->endpoints = std::move(endpoints);
+
+        // Variable that collect the error code thrown by boost function
+        boost::beast::error_code ec {};
+
+        // Disable the verification. The verification will only be necessary for mutual TLS.
+        std::ignore = setup->ctx.set_verify_mode(boost::asio::ssl::verify_none, ec);
+        if (ec)
+        {
+            spdlog::error("Lily-PQC client context set_verify_mode failed! Why: {}", ec.message());
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+
+        // Force the client to use TLS1.3
+        SSL_CTX_set_min_proto_version(setup->ctx.native_handle(), TLS1_3_VERSION);
+        SSL_CTX_set_max_proto_version(setup->ctx.native_handle(), TLS1_3_VERSION);
+
+        // Set the key exchange algorithm
+        if (SSL_CTX_set1_groups_list(setup->ctx.native_handle(), options.tlsGroup.c_str()) <= 0)
+        {
+            spdlog::error("Lily-PQC client context set key exchange algorithm failed! Cause: SSL_CTX_set1_groups_list");
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+
+        // Set the supported signature algorithm
+        auto sigalgs {options.sigalgs.empty() ? constants::SUPPORTED_SIGALGS_LIST : options.sigalgs.c_str()};
+        if (SSL_CTX_set1_sigalgs_list(setup->ctx.native_handle(), sigalgs) <= 0)
+        {
+            spdlog::error(
+                "Lily-PQC client context set supported signature algorithm failed! Cause: SSL_CTX_set1_sigalgs_list");
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+
+        // Set up an HTTP POST request message, the body and its length are sent separately after the serialized header
+        boost::beast::http::request<boost::beast::http::empty_body> req {boost::beast::http::verb::post, "/", 11};
+        req.set(boost::beast::http::field::host, options.serverHost);
+        req.set(boost::beast::http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+        req.set(boost::beast::http::field::content_type, "application/octet-stream");
+
+        // Serialize both variants of the header, the last request of a connection asks the server to close it
+        auto serialize {[&req](bool keepAlive)
+                        {
+                            req.keep_alive(keepAlive);
+                            std::ostringstream header {};
+                            header << req.base();
+
+                            // Drop the empty line ending the header, it follows the `Content-Length` of each request
+                            auto serialized {std::move(header).str()};
+                            serialized.resize(serialized.size() - 2);
+                            return serialized;
+                        }};
+        setup->keepAliveHeader = serialize(true);
+        setup->closeHeader     = serialize(false);
+
+        return setup;
+    }
+} // namespace lily::net
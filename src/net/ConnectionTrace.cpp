@@ -0,0 +1,169 @@
+#include <openssl/objects.h>
+#include <openssl/ssl3.h>
+
+#include <lily/net/ConnectionTrace.h>
+
+namespace lily::net
+{
+    ConnectionTrace::ConnectionTrace(SSL* ssl):
+        ssl(ssl), beginHandshake(std::chrono::high_resolution_clock::now()), context({log::ConnectionContext::makeId()})
+    {
+        SSL_set_ex_data(this->ssl, getIndex(), this);
+        SSL_set_msg_callback(this->ssl, onMessage);
+        SSL_set_msg_callback_arg(this->ssl, this);
+        SSL_set_info_callback(this->ssl, onInfo);
+    }
+
+    ConnectionTrace::~ConnectionTrace()
+    {
+        // A failed handshake never reports its end, and a pooled `SSL` object keeps its callbacks
+        this->detach();
+    }
+
+    int ConnectionTrace::getIndex()
+    {
+        static int const index {SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr)};
+        return index;
+    }
+
+    void ConnectionTrace::detach()
+    {
+        this->leave();
+        SSL_set_info_callback(this->ssl, nullptr);
+        SSL_set_msg_callback(this->ssl, nullptr);
+        SSL_set_msg_callback_arg(this->ssl, nullptr);
+        SSL_set_ex_data(this->ssl, getIndex(), nullptr);
+    }
+
+    void ConnectionTrace::enter()
+    {
+        log::ConnectionContext::current = &this->context;
+    }
+
+    void ConnectionTrace::leave()
+    {
+        if (log::ConnectionContext::current == &this->context)
+            log::ConnectionContext::current = nullptr;
+    }
+
+    void ConnectionTrace::onMessage(int writeP, int, int contentType, void const* buf, std::size_t len, SSL* ssl,
+                                    void* arg)
+    {
+        auto trace {static_cast<ConnectionTrace*>(arg)};
+        auto bytes {static_cast<unsigned char const*>(buf)};
+        trace->enter();
+
+        // Every record header goes through the callback, the length of the record follows its type and version
+        if (contentType == SSL3_RT_HEADER and len == SSL3_RT_HEADER_LENGTH)
+        {
+            auto recordSize {SSL3_RT_HEADER_LENGTH + (bytes[3] << 8 | bytes[4])};
+            if (writeP == 1)
+            {
+                trace->traffic.bytesSent += recordSize;
+                ++trace->traffic.recordsSent;
+            }
+            else
+            {
+                trace->traffic.bytesReceived += recordSize;
+                ++trace->traffic.recordsReceived;
+            }
+            return;
+        }
+
+        // The alerts and the inner content types go through the same callback
+        if (contentType != SSL3_RT_HANDSHAKE or len == 0)
+            return;
+
+        // The server messages are the ones written by the server or read by the client. The client certificates
+        // aren't traced.
+        auto fromServer {(writeP == 1) == (SSL_is_server(ssl) == 1)};
+        Message message {};
+        switch (bytes[0])
+        {
+        case SSL3_MT_CLIENT_HELLO:
+            message = LILY_MESSAGE_CLIENT_HELLO;
+            break;
+        case SSL3_MT_SERVER_HELLO:
+            message = LILY_MESSAGE_SERVER_HELLO;
+            break;
+        case SSL3_MT_ENCRYPTED_EXTENSIONS:
+            message = LILY_MESSAGE_ENCRYPTED_EXTENSIONS;
+            break;
+        case SSL3_MT_CERTIFICATE:
+            if (!fromServer)
+                return;
+            message = LILY_MESSAGE_CERTIFICATE;
+            break;
+        case SSL3_MT_CERTIFICATE_VERIFY:
+            if (!fromServer)
+                return;
+            message = LILY_MESSAGE_CERTIFICATE_VERIFY;
+            break;
+        case SSL3_MT_FINISHED:
+            message = fromServer ? LILY_MESSAGE_SERVER_FINISHED : LILY_MESSAGE_CLIENT_FINISHED;
+            break;
+        default:
+            return;
+        }
+
+        // A HelloRetryRequest sends the hellos twice, the phases are measured from the last ones
+        trace->messages[message] = std::chrono::high_resolution_clock::now();
+    }
+
+    void ConnectionTrace::onInfo(SSL const* ssl, int where, int)
+    {
+        auto trace {static_cast<ConnectionTrace*>(SSL_get_ex_data(ssl, getIndex()))};
+        if (!trace)
+            return;
+
+        // The handshake starts before the client key share is generated, and each step of OpenSSL ends with an exit.
+        // With the asynchronous engines, the next step may run on another thread.
+        if (where & SSL_CB_HANDSHAKE_DONE)
+            trace->detach();
+        else if (where & SSL_CB_EXIT)
+            trace->leave();
+        else
+            trace->enter();
+    }
+
+    log::HandshakePhases ConnectionTrace::getPhases() const
+    {
+        // Each phase ends at its message and starts at the previous message seen
+        std::array<int64_t, LILY_MESSAGE_COUNT> phases {};
+        auto previous {this->beginHandshake};
+        for (std::size_t i {}; i < LILY_MESSAGE_COUNT; ++i)
+        {
+            if (this->messages[i] == std::chrono::high_resolution_clock::time_point {})
+                continue;
+            phases[i] = std::chrono::duration_cast<std::chrono::microseconds>(this->messages[i] - previous).count();
+            previous  = this->messages[i];
+        }
+
+        return {phases[LILY_MESSAGE_CLIENT_HELLO],      phases[LILY_MESSAGE_SERVER_HELLO],
+                phases[LILY_MESSAGE_ENCRYPTED_EXTENSIONS], phases[LILY_MESSAGE_CERTIFICATE],
+                phases[LILY_MESSAGE_CERTIFICATE_VERIFY], phases[LILY_MESSAGE_SERVER_FINISHED],
+                phases[LILY_MESSAGE_CLIENT_FINISHED]};
+    }
+
+    log::NegotiatedParameters ConnectionTrace::getParameters() const
+    {
+        log::NegotiatedParameters parameters {};
+
+        // The groups of the provider have no NID, `SSL_group_to_name` names them from the id kept in the returned value
+        if (auto group {SSL_get_negotiated_group(this->ssl)}; group != 0)
+            if (auto name {SSL_group_to_name(this->ssl, group)})
+                parameters.group = log::makeLogName(name);
+
+        // The server signs with its own algorithm, the client reads the one of its peer
+        int sigalg {NID_undef};
+        auto found {SSL_is_server(this->ssl) == 1 ? SSL_get_signature_type_nid(this->ssl, &sigalg)
+                                                  : SSL_get_peer_signature_type_nid(this->ssl, &sigalg)};
+        if (found == 1 and sigalg != NID_undef)
+            if (auto name {OBJ_nid2sn(sigalg)})
+                parameters.sigalg = log::makeLogName(name);
+
+        if (auto cipher {SSL_get_current_cipher(this->ssl)})
+            parameters.cipher = log::makeLogName(SSL_CIPHER_get_name(cipher));
+        return parameters;
+    }
+} // namespace lily::net
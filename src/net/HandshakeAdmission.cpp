@@ -0,0 +1,121 @@
+#include <lily/net/HandshakeAdmission.h>
+
+namespace lily::net
+{
+    HandshakeAdmission::HandshakeAdmission(uint32_t maxInFlight, uint32_t maxQueued, OverflowPolicy policy):
+        maxInFlight {maxInFlight}, maxQueued {maxQueued}, policy {policy}
+    {
+    }
+
+    std::unique_ptr<HandshakeAdmission> HandshakeAdmission::create(ServerOptions const& options)
+    {
+        if (options.maxHandshakes == 0)
+            return nullptr;
+        return std::make_unique<HandshakeAdmission>(options.maxHandshakes, options.admissionQueueSize,
+                                                    options.overflowPolicy);
+    }
+
+    HandshakeAdmission::Decision HandshakeAdmission::decide()
+    {
+        if (this->inFlight < this->maxInFlight)
+        {
+            ++this->inFlight;
+            this->admittedCount.fetch_add(1, std::memory_order_relaxed);
+            return Decision::ADMIT;
+        }
+
+        switch (this->policy)
+        {
+        case OverflowPolicy::LILY_OVERFLOW_QUEUE:
+            if (this->waiters.size() < this->maxQueued)
+                break;
+            [[fallthrough]];
+        case OverflowPolicy::LILY_OVERFLOW_REJECT:
+            this->shedCount.fetch_add(1, std::memory_order_relaxed);
+            return Decision::SHED;
+        case OverflowPolicy::LILY_OVERFLOW_DELAY:
+            break;
+        }
+
+        // The slot is handed over by `release`, so the connection is counted as admitted once woken up
+        this->queuedCount.fetch_add(1, std::memory_order_relaxed);
+        return Decision::WAIT;
+    }
+
+    bool HandshakeAdmission::acquire()
+    {
+        std::unique_lock lock {this->mtx};
+        switch (this->decide())
+        {
+        case Decision::ADMIT:
+            return true;
+        case Decision::SHED:
+            return false;
+        case Decision::WAIT:
+            break;
+        }
+
+        bool woken {};
+        this->waiters.emplace_back([&woken] { woken = true; });
+        this->cv.wait(lock, [&woken] { return woken; });
+        this->admittedCount.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    boost::asio::awaitable<bool> HandshakeAdmission::asyncAcquire()
+    {
+        auto timer {std::make_shared<boost::asio::steady_timer>(co_await boost::asio::this_coro::executor,
+                                                                boost::asio::steady_timer::time_point::max())};
+        {
+            std::lock_guard lock {this->mtx};
+            switch (this->decide())
+            {
+            case Decision::ADMIT:
+                co_return true;
+            case Decision::SHED:
+                co_return false;
+            case Decision::WAIT:
+                break;
+            }
+
+            // The cancellation is posted to the strand of the waiting coroutine, so it can't run before the wait
+            // below has started
+            this->waiters.emplace_back(
+                [timer] { boost::asio::post(timer->get_executor(), [timer] { timer->cancel(); }); });
+        }
+
+        boost::system::error_code ec {};
+        co_await timer->async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+        this->admittedCount.fetch_add(1, std::memory_order_relaxed);
+        co_return true;
+    }
+
+    void HandshakeAdmission::release()
+    {
+        std::lock_guard lock {this->mtx};
+        if (this->waiters.empty())
+        {
+            --this->inFlight;
+            return;
+        }
+
+        // Hand the slot over to the oldest queued connection
+        auto wake {std::move(this->waiters.front())};
+        this->waiters.pop_front();
+        wake();
+        this->cv.notify_all();
+    }
+
+    void HandshakeAdmission::reset(boost::asio::ip::tcp::socket& socket)
+    {
+        boost::system::error_code ec {};
+        std::ignore = socket.set_option(boost::asio::socket_base::linger(true, 0), ec);
+        std::ignore = socket.close(ec);
+    }
+
+    uint32_t HandshakeAdmission::getInFlight()
+    {
+        std::lock_guard lock {this->mtx};
+        return this->inFlight;
+    }
+} // namespace lily::net
@@ -0,0 +1,103 @@
+#include <openssl/bio.h>
+
+#include <lily/net/KtlsStream.h>
+
+namespace lily::net
+{
+    KtlsStream::KtlsStream(boost::asio::ip::tcp::socket&& socket, SSL* ssl):
+        socket(std::move(socket)), ssl(ssl, SSL_free)
+    {
+    }
+
+    bool KtlsStream::shouldRetry(int result, boost::asio::socket_base::wait_type& wait,
+                                 boost::system::error_code& ec) const
+    {
+        ec = {};
+        if (result > 0)
+            return false;
+
+        switch (SSL_get_error(this->ssl.get(), result))
+        {
+        case SSL_ERROR_WANT_READ:
+            wait = boost::asio::socket_base::wait_read;
+            return true;
+        case SSL_ERROR_WANT_WRITE:
+            wait = boost::asio::socket_base::wait_write;
+            return true;
+        case SSL_ERROR_ZERO_RETURN:
+            ec = boost::asio::error::eof;
+            return false;
+        case SSL_ERROR_SYSCALL:
+            // A peer closing the socket without close notify truncates the stream, as for `boost::asio::ssl::stream`
+            if (errno != 0)
+                ec = {errno, boost::system::system_category()};
+            else
+                ec = boost::asio::ssl::error::stream_truncated;
+            return false;
+        default:
+            if (auto err {ERR_peek_last_error()}; ERR_GET_REASON(err) == SSL_R_UNEXPECTED_EOF_WHILE_READING)
+                ec = boost::asio::ssl::error::stream_truncated;
+            else
+                ec = {static_cast<int>(err), boost::asio::error::get_ssl_category()};
+            return false;
+        }
+    }
+
+    bool KtlsStream::isKtlsSend() const
+    {
+        auto wbio {SSL_get_wbio(this->ssl.get())};
+        return wbio and BIO_get_ktls_send(wbio);
+    }
+
+    bool KtlsStream::isKtlsRecv() const
+    {
+        auto rbio {SSL_get_rbio(this->ssl.get())};
+        return rbio and BIO_get_ktls_recv(rbio);
+    }
+
+    void KtlsStream::prepare(boost::asio::ssl::stream_base::handshake_type type, boost::system::error_code& ec)
+    {
+        // The socket is waited on explicitly, so OpenSSL must never block on it
+        std::ignore = this->socket.non_blocking(true, ec);
+        if (ec)
+            return;
+
+        // OpenSSL enables kTLS on the socket BIO once the handshake is done, if the kernel supports the negotiated
+        // cipher. Otherwise the records keep being encrypted in user space.
+        if (!this->ssl or SSL_set_fd(this->ssl.get(), this->socket.native_handle()) <= 0)
+        {
+            ec = {static_cast<int>(ERR_get_error()), boost::asio::error::get_ssl_category()};
+            return;
+        }
+        SSL_set_options(this->ssl.get(), SSL_OP_ENABLE_KTLS);
+        SSL_set_mode(this->ssl.get(), SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+        if (type == boost::asio::ssl::stream_base::client)
+            SSL_set_connect_state(this->ssl.get());
+        else
+            SSL_set_accept_state(this->ssl.get());
+    }
+
+    boost::system::error_code KtlsStream::handshake(boost::asio::ssl::stream_base::handshake_type type,
+                                                    boost::system::error_code& ec)
+    {
+        this->prepare(type, ec);
+        if (ec)
+            return ec;
+
+        std::ignore = this->perform([this](std::size_t&) { return SSL_do_handshake(this->ssl.get()); }, ec);
+        return ec;
+    }
+
+    boost::system::error_code KtlsStream::shutdown(boost::system::error_code& ec)
+    {
+        // The first call only sends the close notify, the second one waits for the close notify of the peer
+        std::ignore = this->perform(
+            [this](std::size_t&)
+            {
+                auto result {SSL_shutdown(this->ssl.get())};
+                return result == 0 ? SSL_shutdown(this->ssl.get()) : result;
+            },
+            ec);
+        return ec;
+    }
+} // namespace lily::net
@@ -0,0 +1,77 @@
+#include <chrono>
+#include <spdlog/spdlog.h>
+
+#include <lily/net/AcceptRetry.h>
+#include <lily/net/MetricsEndpoint.h>
+#include <lily/net/ServerMetrics.h>
+
+namespace lily::net
+{
+    MetricsEndpoint::MetricsEndpoint():
+        ioc {std::make_unique<boost::beast::net::io_context>(1)}, acceptor {*ioc.get()}
+    {
+    }
+
+    void MetricsEndpoint::start()
+    {
+        boost::asio::co_spawn(*this->ioc, this->acceptScrapes(), boost::asio::detached);
+        this->thread = std::jthread {[this] { this->ioc->run(); }};
+    }
+
+    boost::asio::awaitable<void> MetricsEndpoint::acceptScrapes()
+    {
+        // Variable that collect the error code thrown by boost function
+        boost::beast::error_code ec {};
+
+        while (true)
+        {
+            auto socket {
+                co_await this->acceptor.async_accept(boost::asio::redirect_error(boost::asio::use_awaitable, ec))};
+            if (ec)
+            {
+                if (!co_await retryAccept(this->acceptor, ec, "server metrics"))
+                    co_return;
+                continue;
+            }
+            co_await this->serveScrape(std::move(socket));
+        }
+    }
+
+    boost::asio::awaitable<void> MetricsEndpoint::serveScrape(boost::asio::ip::tcp::socket socket)
+    {
+        // Variable that collect the error code thrown by boost function
+        boost::beast::error_code ec {};
+
+        // A stalled scraper must not hold the endpoint
+        boost::beast::tcp_stream stream {std::move(socket)};
+        stream.expires_after(std::chrono::seconds {5});
+
+        boost::beast::flat_buffer buffer {};
+        boost::beast::http::request<boost::beast::http::empty_body> req {};
+        co_await boost::beast::http::async_read(stream, buffer, req,
+                                                boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+        if (ec)
+            co_return;
+
+        // Create the HTTP response, the connection is closed after each scrape
+        boost::beast::http::response<boost::beast::http::string_body> res {boost::beast::http::status::ok,
+                                                                           req.version()};
+        res.set(boost::beast::http::field::server, BOOST_BEAST_VERSION_STRING);
+        res.set(boost::beast::http::field::connection, "close");
+        res.keep_alive(false);
+        if (req.method() == boost::beast::http::verb::get and req.target() == "/metrics")
+        {
+            res.set(boost::beast::http::field::content_type, "text/plain; version=0.0.4; charset=utf-8");
+            res.body() = ServerMetrics::getInstance().format();
+        }
+        else
+            res.result(boost::beast::http::status::not_found);
+        res.prepare_payload();
+
+        co_await boost::beast::http::async_write(stream, res,
+                                                 boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+        if (ec)
+            spdlog::error("Lily-PQC server metrics write failed! Why: {}", ec.message());
+        std::ignore = stream.socket().shutdown(boost::asio::ip::tcp::socket::shutdown_send, ec);
+    }
+} // namespace lily::net
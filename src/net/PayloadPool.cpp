@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <openssl/rand.h>
+#include <spdlog/spdlog.h>
+
+#include <lily/net/PayloadPool.h>
+
+using namespace lily::core;
+
+namespace lily::net
+{
+    // The default maximum of the log-normal sizes, as a multiple of their median
+    static constexpr uint32_t DEFAULT_MAX_LENGTH_FACTOR {16};
+
+    Expect<PayloadPool> PayloadPool::create(ClientOptions const& options)
+    {
+        PayloadPool pool {};
+        pool.distribution = options.payloadDistribution;
+        switch (options.payloadDistribution)
+        {
+        case PayloadDistribution::LILY_PAYLOAD_FIXED:
+            pool.minLength = options.dummyDataLength;
+            pool.maxLength = options.dummyDataLength;
+            break;
+        case PayloadDistribution::LILY_PAYLOAD_UNIFORM:
+            pool.minLength = std::min(options.payloadMinLength, options.dummyDataLength);
+            pool.maxLength = options.dummyDataLength;
+            break;
+        case PayloadDistribution::LILY_PAYLOAD_LOGNORMAL:
+            pool.maxLength = options.payloadMaxLength != 0 ? options.payloadMaxLength
+                                                           : options.dummyDataLength * DEFAULT_MAX_LENGTH_FACTOR;
+            pool.minLength = std::min(options.payloadMinLength, pool.maxLength);
+            pool.lognormal = std::lognormal_distribution<double>::param_type {
+                std::log(std::max(options.dummyDataLength, 1u)), options.payloadSigma};
+            break;
+        case PayloadDistribution::LILY_PAYLOAD_EMPIRICAL:
+            if (auto outcome {pool.loadHistogram(options.payloadHistogramFile)}; !outcome)
+                return outcome.error();
+            pool.maxLength = *std::max_element(pool.empiricalSizes.begin(), pool.empiricalSizes.end());
+            break;
+        }
+
+        // Random bytes don't compress, whatever the path between the client and the server
+        pool.buffer.resize(pool.maxLength + OFFSET_RANGE);
+        if (RAND_bytes(reinterpret_cast<unsigned char*>(pool.buffer.data()), static_cast<int>(pool.buffer.size())) <= 0)
+        {
+            spdlog::error("Lily-PQC client payload pool fill failed! Cause: RAND_bytes");
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+        return pool;
+    }
+
+    Expect<void> PayloadPool::loadHistogram(std::string const& fileName)
+    {
+        std::ifstream stream {fileName};
+        if (!stream.is_open())
+        {
+            spdlog::error("Lily-PQC client failed to open payload histogram `{}`", fileName);
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+
+        std::vector<double> weights {};
+        std::string line {};
+        for (std::size_t lineNumber {1}; std::getline(stream, line); ++lineNumber)
+        {
+            if (!line.empty() and line.back() == '\r')
+                line.pop_back();
+            if (line.empty())
+                continue;
+
+            uint32_t size {};
+            double weight {};
+            auto separator {line.find(';')};
+            auto sizeResult {std::from_chars(line.data(), line.data() + std::min(separator, line.size()), size)};
+            auto weightResult {separator == std::string::npos
+                                   ? std::from_chars_result {line.data(), std::errc::invalid_argument}
+                                   : std::from_chars(line.data() + separator + 1, line.data() + line.size(), weight)};
+            if (sizeResult.ec != std::errc {} or weightResult.ec != std::errc {} or weight < 0)
+            {
+                spdlog::error("Lily-PQC client payload histogram `{}` is invalid at line {}, expected `size;weight`",
+                              fileName, lineNumber);
+                return ErrorCode::LILY_ERRORCODE_EXPECTED;
+            }
+            this->empiricalSizes.push_back(size);
+            weights.push_back(weight);
+        }
+        if (std::find_if(weights.begin(), weights.end(), [](double weight) { return weight > 0; }) == weights.end())
+        {
+            spdlog::error("Lily-PQC client payload histogram `{}` has no positive weight", fileName);
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+
+        this->empiricalWeights = std::discrete_distribution<std::size_t>::param_type {weights.begin(), weights.end()};
+        return success;
+    }
+
+    uint32_t PayloadPool::drawSize(std::mt19937_64& generator) const
+    {
+        // The distributions only keep their parameters, so they are rebuilt around the shared ones on each draw
+        switch (this->distribution)
+        {
+        case PayloadDistribution::LILY_PAYLOAD_UNIFORM:
+            return std::uniform_int_distribution<uint32_t> {this->minLength, this->maxLength}(generator);
+        case PayloadDistribution::LILY_PAYLOAD_LOGNORMAL:
+        {
+            auto size {std::lround(std::lognormal_distribution<double> {this->lognormal}(generator))};
+            return static_cast<uint32_t>(std::clamp<long>(size, this->minLength, this->maxLength));
+        }
+        case PayloadDistribution::LILY_PAYLOAD_EMPIRICAL:
+            return this->empiricalSizes[std::discrete_distribution<std::size_t> {}(generator, this->empiricalWeights)];
+        default:
+            return this->maxLength;
+        }
+    }
+
+    boost::asio::const_buffer PayloadPool::getSlice(uint32_t size, std::mt19937_64& generator) const
+    {
+        auto offset {std::uniform_int_distribution<std::size_t> {0, this->buffer.size() - size}(generator)};
+        return boost::asio::buffer(this->buffer.data() + offset, size);
+    }
+} // namespace lily::net
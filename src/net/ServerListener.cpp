@@ -1,32 +1,129 @@
+#include <fmt/core.h>
 #include <spdlog/spdlog.h>
 #include <thread>
 
 #include <lily/core/Constants.h>
 #include <lily/crypto/OQSLoader.h>
+#include <lily/crypto/PrimitiveHook.h>
+#include <lily/log/PrimitiveLog.h>
+#include <lily/log/ServerLog.h>
+#include <lily/net/AcceptRetry.h>
+#include <lily/net/AsyncServerSession.h>
 #include <lily/net/ServerListener.h>
+#include <lily/net/ServerMetrics.h>
 #include <lily/net/ServerSession.h>
+#include <lily/net/SessionPool.h>
 
 using namespace lily::core;
 
 namespace lily::net
 {
-    ServerListener::ServerListener(uint16_t port):
-        ioc {std::make_unique<boost::beast::net::io_context>(1)}, ctx {boost::asio::ssl::context::tlsv13_server},
-        endpoint {boost::asio::ip::make_address(constants::DEFAULT_SERVER_HOST), port}, acceptor {*ioc.get()}
+    ServerListener::ServerListener(ServerOptions const& options):
+        ioc {std::make_unique<boost::beast::net::io_context>(std::max<int32_t>(options.threads, 1))},
+        ctx {boost::asio::ssl::context::tlsv13_server},
+        endpoint {boost::asio::ip::make_address(constants::DEFAULT_SERVER_HOST), options.port}, acceptor {*ioc.get()},
+        options {options}
     {
     }
 
-    Expect<ServerListener> ServerListener::create(uint16_t port, std::filesystem::path const& serverCertificatePath,
-                                                  std::filesystem::path const& privateKeyPath)
+    Expect<ServerListener> ServerListener::create(ServerOptions const& options)
     {
+        // kTLS needs the `SSL` object to own the socket, which only the synchronous sessions do
+        if (options.ktls and (options.threads > 0 or options.shards > 0))
+        {
+            spdlog::error("Lily-PQC server kTLS is only available with the thread-per-connection engine! Cause: "
+                          "--threads or --shards");
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+
+        // The records are logged before the first connection is accepted
+        log::ServerLog::setFormat(options.logFormat);
+        log::ServerLog::setOverflow(options.logOverflow);
+
+        // Log the primitives run by the handshakes next to the connections
+        log::PrimitiveLog::setFilePrefix(log::ServerLog::getFilePrefix());
+        log::PrimitiveLog::setFormat(options.logFormat);
+        log::PrimitiveLog::setOverflow(options.logOverflow);
+        crypto::installPrimitiveHook();
+
         // Create the `ServerListener` default instance
-        ServerListener listener {port};
+        ServerListener listener {options};
+        listener.admission = HandshakeAdmission::create(options);
+        SessionPool::getInstance().setCapacity(options.poolSize);
+
+        // Load every key/certificate pair of the directory, the handshakes choose between them
+        if (!options.certificateDirectory.empty())
+        {
+            auto outcomeCertificates {CertificateStore::load(options.certificateDirectory)};
+            if (!outcomeCertificates)
+                return outcomeCertificates.error();
+            listener.certificates = std::move(outcomeCertificates.assume_value());
+        }
+        else if (options.certificatePath.empty() or options.privateKeyPath.empty())
+        {
+            spdlog::error("Lily-PQC server has no certificate! Cause: --certificate-file and --private-key-file, or "
+                          "--certificate-dir");
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+
+        // Configure the TLS context shared by the non-sharded engines
+        BOOST_OUTCOME_TRY(configureContext(listener.ctx, options, listener.certificates.get()));
+
+        // Open the metrics endpoint before the workers start recording
+        if (options.metricsPort != 0)
+        {
+            listener.metrics = std::make_unique<MetricsEndpoint>();
+            BOOST_OUTCOME_TRY(openAcceptor(
+                listener.metrics->getAcceptor(),
+                {boost::asio::ip::make_address(constants::DEFAULT_SERVER_HOST), options.metricsPort}, false));
+            ServerMetrics::getInstance().enable();
+        }
+
+        // Without sharding, a single acceptor serves every connection
+        if (options.shards == 0)
+        {
+            BOOST_OUTCOME_TRY(openAcceptor(listener.acceptor, listener.endpoint, false));
+            return listener;
+        }
+
+        // Otherwise each shard owns its acceptor, `io_context` and copy of the TLS context. The acceptors share the
+        // port with `SO_REUSEPORT`, so the kernel balances the incoming connections between the shards.
+        for (uint32_t index {}; index < options.shards; ++index)
+        {
+            auto shard {std::make_unique<ServerShard>(index, options)};
+            BOOST_OUTCOME_TRY(configureContext(shard->getContext(), options, listener.certificates.get()));
+            BOOST_OUTCOME_TRY(openAcceptor(shard->getAcceptor(), listener.endpoint, true));
+            listener.shards.emplace_back(std::move(shard));
+        }
+
+        // Share the ticket keys between the shards, so a stateless ticket issued by one shard can be resumed by the
+        // others. The stateful session caches stay private to each shard.
+        std::array<uint8_t, 80> ticketKeys {};
+        if (SSL_CTX_get_tlsext_ticket_keys(listener.ctx.native_handle(), ticketKeys.data(), ticketKeys.size()) <= 0)
+        {
+            spdlog::error("Lily-PQC server context get ticket keys failed! Cause: SSL_CTX_get_tlsext_ticket_keys");
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+        for (auto& shard: listener.shards)
+        {
+            if (SSL_CTX_set_tlsext_ticket_keys(shard->getContext().native_handle(), ticketKeys.data(),
+                                               ticketKeys.size()) <= 0)
+            {
+                spdlog::error("Lily-PQC server context set ticket keys failed! Cause: SSL_CTX_set_tlsext_ticket_keys");
+                return ErrorCode::LILY_ERRORCODE_EXPECTED;
+            }
+        }
+        return listener;
+    }
 
+    Expect<void> ServerListener::openAcceptor(boost::asio::ip::tcp::acceptor& acceptor,
+                                              boost::asio::ip::tcp::endpoint const& endpoint, bool reusePort)
+    {
         // Variable that collect the error code thrown by boost function
         boost::beast::error_code ec {};
 
         // Open the socket communication
-        std::ignore = listener.acceptor.open(listener.endpoint.protocol(), ec);
+        std::ignore = acceptor.open(endpoint.protocol(), ec);
         if (ec)
         {
             spdlog::error("Lily-PQC server connection open failed! Why: {}", ec.message());
@@ -34,15 +131,27 @@ namespace lily::net
         }
 
         // Allow address reuse
-        std::ignore = listener.acceptor.set_option(boost::beast::net::socket_base::reuse_address(true), ec);
+        std::ignore = acceptor.set_option(boost::beast::net::socket_base::reuse_address(true), ec);
         if (ec)
         {
             spdlog::error("Lily-PQC server connection set_option failed! Why: {}", ec.message());
             return ErrorCode::LILY_ERRORCODE_EXPECTED;
         }
 
+        // Allow several acceptors to bind the same port
+        if (reusePort)
+        {
+            using reuse_port = boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+            std::ignore = acceptor.set_option(reuse_port(true), ec);
+            if (ec)
+            {
+                spdlog::error("Lily-PQC server connection set_option SO_REUSEPORT failed! Why: {}", ec.message());
+                return ErrorCode::LILY_ERRORCODE_EXPECTED;
+            }
+        }
+
         // Bind to the server address
-        std::ignore = listener.acceptor.bind(listener.endpoint, ec);
+        std::ignore = acceptor.bind(endpoint, ec);
         if (ec)
         {
             spdlog::error("Lily-PQC server connection bind failed! Why: {}", ec.message());
@@ -50,38 +159,55 @@ namespace lily::net
         }
 
         // Start listening for connections
-        std::ignore = listener.acceptor.listen(boost::beast::net::socket_base::max_listen_connections, ec);
+        std::ignore = acceptor.listen(boost::beast::net::socket_base::max_listen_connections, ec);
         if (ec)
         {
             spdlog::error("Lily-PQC server connection listen failed! Why: {}", ec.message());
             return ErrorCode::LILY_ERRORCODE_EXPECTED;
         }
 
-        // Load the certificate
-        std::ignore = listener.ctx.use_certificate_chain_file(serverCertificatePath, ec);
-        if (ec)
-        {
-            spdlog::error("Lily-PQC server context use_certificate_chain_file failed! Why: {}\r\n", ec.message());
-            return ErrorCode::LILY_ERRORCODE_EXPECTED;
-        }
+        return success;
+    }
 
-        // Load the private key
-        std::ignore = listener.ctx.use_private_key_file(privateKeyPath, boost::asio::ssl::context::pem, ec);
-        if (ec)
+    Expect<void> ServerListener::configureContext(boost::asio::ssl::context& ctx, ServerOptions const& options,
+                                                  CertificateStore const* certificates)
+    {
+        // Variable that collect the error code thrown by boost function
+        boost::beast::error_code ec {};
+
+        // Let the handshakes choose between the pairs of the store
+        if (certificates)
         {
-            spdlog::error("Lily-PQC server context use_certificate_chain_file failed! Why: {}\r\n", ec.message());
-            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+            BOOST_OUTCOME_TRY(certificates->attach(ctx.native_handle()));
         }
-
-        // Check whether the private key and certificate match or not
-        if (SSL_CTX_check_private_key(listener.ctx.native_handle()) <= 0)
+        else
         {
-            spdlog::error("Lily-PQC server private key and certificate mismatch! Cause: SSL_CTX_check_private_key");
-            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+            // Load the certificate
+            std::ignore = ctx.use_certificate_chain_file(options.certificatePath, ec);
+            if (ec)
+            {
+                spdlog::error("Lily-PQC server context use_certificate_chain_file failed! Why: {}\r\n", ec.message());
+                return ErrorCode::LILY_ERRORCODE_EXPECTED;
+            }
+
+            // Load the private key
+            std::ignore = ctx.use_private_key_file(options.privateKeyPath, boost::asio::ssl::context::pem, ec);
+            if (ec)
+            {
+                spdlog::error("Lily-PQC server context use_certificate_chain_file failed! Why: {}\r\n", ec.message());
+                return ErrorCode::LILY_ERRORCODE_EXPECTED;
+            }
+
+            // Check whether the private key and certificate match or not
+            if (SSL_CTX_check_private_key(ctx.native_handle()) <= 0)
+            {
+                spdlog::error("Lily-PQC server private key and certificate mismatch! Cause: SSL_CTX_check_private_key");
+                return ErrorCode::LILY_ERRORCODE_EXPECTED;
+            }
         }
 
         // Disable the verification. The verification will only be necessary for mutual TLS.
-        std::ignore = listener.ctx.set_verify_mode(boost::asio::ssl::verify_none, ec);
+        std::ignore = ctx.set_verify_mode(boost::asio::ssl::verify_none, ec);
         if (ec)
         {
             spdlog::error("Lily-PQC server context set_verify_mode failed! Why: {}", ec.message());
@@ -90,37 +216,84 @@ namespace lily::net
 
         // Configure the session id to avoid undefined session id context
         constexpr std::array<uint8_t, SSL_MAX_SID_CTX_LENGTH> sessionId {};
-        if (SSL_CTX_set_session_id_context(listener.ctx.native_handle(), sessionId.data(), sessionId.size()) <= 0)
+        if (SSL_CTX_set_session_id_context(ctx.native_handle(), sessionId.data(), sessionId.size()) <= 0)
         {
             spdlog::error("Lily-PQC server context set_session_id_context failed!");
             return ErrorCode::LILY_ERRORCODE_EXPECTED;
         }
 
+        // Configure the session resumption. A TLS 1.3 server with `SSL_OP_NO_TICKET` still issues tickets, but they
+        // only hold the id of the session stored in the stateful cache.
+        if (options.sessionCacheSize > 0)
+        {
+            SSL_CTX_set_session_cache_mode(ctx.native_handle(), SSL_SESS_CACHE_SERVER);
+            SSL_CTX_sess_set_cache_size(ctx.native_handle(), options.sessionCacheSize);
+            SSL_CTX_set_options(ctx.native_handle(), SSL_OP_NO_TICKET);
+        }
+        else
+            SSL_CTX_set_session_cache_mode(ctx.native_handle(), SSL_SESS_CACHE_OFF);
+        if (SSL_CTX_set_num_tickets(ctx.native_handle(), options.sessionTickets) <= 0)
+        {
+            spdlog::error("Lily-PQC server context set number of session tickets failed! Cause: SSL_CTX_set_num_tickets");
+            return ErrorCode::LILY_ERRORCODE_EXPECTED;
+        }
+
         // Only allow TLS 1.3 for communication
-        SSL_CTX_set_options(listener.ctx.native_handle(),
+        SSL_CTX_set_options(ctx.native_handle(),
                             SSL_OP_ALLOW_CLIENT_RENEGOTIATION | SSL_OP_CIPHER_SERVER_PREFERENCE);
-        SSL_CTX_set_min_proto_version(listener.ctx.native_handle(), TLS1_3_VERSION);
-        SSL_CTX_set_max_proto_version(listener.ctx.native_handle(), TLS1_3_VERSION);
+        SSL_CTX_set_min_proto_version(ctx.native_handle(), TLS1_3_VERSION);
+        SSL_CTX_set_max_proto_version(ctx.native_handle(), TLS1_3_VERSION);
 
         // Set the key exchange algorithm
-        if (SSL_CTX_set1_groups_list(listener.ctx.native_handle(), constants::SUPPORTED_PQC_GROUPS_LIST) <= 0)
+        if (SSL_CTX_set1_groups_list(ctx.native_handle(), constants::SUPPORTED_PQC_GROUPS_LIST) <= 0)
         {
             spdlog::error("Lily-PQC server context set key exchange algorithm failed! Cause: SSL_CTX_set1_groups_list");
             return ErrorCode::LILY_ERRORCODE_EXPECTED;
         }
 
         // Set the supported signature algorithm
-        if (SSL_CTX_set1_sigalgs_list(listener.ctx.native_handle(), constants::SUPPORTED_SIGALGS_LIST) <= 0)
+        if (SSL_CTX_set1_sigalgs_list(ctx.native_handle(), constants::SUPPORTED_SIGALGS_LIST) <= 0)
         {
             spdlog::error(
                 "Lily-PQC server context set supported signature algorithm failed! Cause: SSL_CTX_set1_sigalgs_list");
             return ErrorCode::LILY_ERRORCODE_EXPECTED;
         }
 
-        return listener;
+        return success;
     }
 
     void ServerListener::run()
+    {
+        if (this->metrics)
+            this->metrics->start();
+
+        if (!this->shards.empty())
+            return this->runSharded();
+
+        // Report how the handshakes were admitted, how much the pool was reused and how long the primitives took
+        std::jthread reporter {[this](std::stop_token stopToken)
+                               {
+                                   while (!stopToken.stop_requested())
+                                   {
+                                       std::this_thread::sleep_for(std::chrono::seconds {5});
+                                       if (this->admission)
+                                           fmt::print("[-] Admitted Handshake: {} | Queued Handshake: {} | Shed "
+                                                      "Handshake: {} | In-flight Handshake: {}\r\n",
+                                                      this->admission->getAdmittedCount(),
+                                                      this->admission->getQueuedCount(),
+                                                      this->admission->getShedCount(),
+                                                      this->admission->getInFlight());
+                                       reportPool();
+                                       log::PrimitiveLog::getInstance().report();
+                                   }
+                               }};
+
+        if (this->options.threads == 0)
+            return this->runThreadPerConnection();
+        return this->runAsync();
+    }
+
+    void ServerListener::runThreadPerConnection()
     {
         // Variable that collect the error code thrown by boost function
         boost::beast::error_code ec {};
@@ -130,12 +303,112 @@ namespace lily::net
             // This will receive the new connection
             boost::asio::ip::tcp::socket socket {this->ioc->get_executor()};
 
+            // With the delay policy, the slot is acquired before accepting, so the connections wait in the backlog
+            bool admitted {this->admission and this->admission->getPolicy() == OverflowPolicy::LILY_OVERFLOW_DELAY and
+                           this->admission->acquire()};
+
             // Block until we get a connection
             std::ignore = this->acceptor.accept(socket, ec);
             if (ec)
                 spdlog::error("Lily-PQC server context accept failed! Why: {}", ec.message());
 
-            std::jthread {std::bind(&ServerSession::run, ServerSession {std::move(socket), this->ctx})}.detach();
+            std::jthread {std::bind(&ServerSession::run,
+                                    ServerSession {std::move(socket), this->ctx, this->admission.get(), admitted,
+                                                   this->options.streamWindow, this->options.ktls})}
+                .detach();
+        }
+    }
+
+    void ServerListener::runAsync()
+    {
+        // Start accepting the connections on the shared `io_context`. The accept loop runs on a strand, because it may
+        // wait for a handshake slot.
+        boost::asio::co_spawn(boost::asio::make_strand(*this->ioc), this->acceptAsync(), boost::asio::detached);
+
+        // The calling thread is one of the workers
+        std::vector<std::jthread> workers(this->options.threads - 1);
+        for (auto& worker: workers)
+            worker = std::jthread {[this] { this->ioc->run(); }};
+        this->ioc->run();
+    }
+
+    void ServerListener::runSharded()
+    {
+        // Every shard runs on its own thread pinned to its core
+        std::vector<std::jthread> workers {};
+        for (auto& shard: this->shards)
+            workers.emplace_back([&shard] { shard->run(); });
+
+        // Report the accepted connections and handshakes of every shard, so the load balance can be checked
+        while (true)
+        {
+            std::this_thread::sleep_for(std::chrono::seconds {5});
+
+            for (auto const& shard: this->shards)
+            {
+                auto admission {shard->getAdmission()};
+                if (!admission)
+                {
+                    fmt::print("[-] Shard {} | Accepted Connection: {} | Handshake: {}\r\n", shard->getIndex(),
+                               shard->getAcceptedCount(), shard->getHandshakeCount());
+                    continue;
+                }
+                fmt::print("[-] Shard {} | Accepted Connection: {} | Handshake: {} | Admitted Handshake: {} | Queued "
+                           "Handshake: {} | Shed Handshake: {}\r\n",
+                           shard->getIndex(), shard->getAcceptedCount(), shard->getHandshakeCount(),
+                           admission->getAdmittedCount(), admission->getQueuedCount(), admission->getShedCount());
+            }
+            reportPool();
+            log::PrimitiveLog::getInstance().report();
+        }
+    }
+
+    void ServerListener::reportPool()
+    {
+        auto const& pool {SessionPool::getInstance()};
+        if (!pool.isEnabled())
+            return;
+
+        // Every reused object is one `SSL_new` or read buffer allocation avoided
+        auto acquired {std::max<uint64_t>(pool.getAcquiredCount(), 1)};
+        fmt::print("[-] Pooled SSL Hit: {:.1f}% | Pooled Buffer Hit: {:.1f}% | Allocation Avoided per Handshake: "
+                   "{:.2f}\r\n",
+                   100.0 * pool.getSSLHitCount() / acquired, 100.0 * pool.getBufferHitCount() / acquired,
+                   static_cast<double>(pool.getSSLHitCount() + pool.getBufferHitCount()) / acquired);
+    }
+
+    boost::asio::awaitable<void> ServerListener::acceptAsync()
+    {
+        // Variable that collect the error code thrown by boost function
+        boost::beast::error_code ec {};
+
+        while (true)
+        {
+            // Each connection gets its own strand, so its handlers never run concurrently
+            boost::asio::any_io_executor strand {boost::asio::make_strand(*this->ioc)};
+
+            // With the delay policy, the slot is acquired before accepting, so the connections wait in the backlog
+            bool admitted {this->admission and this->admission->getPolicy() == OverflowPolicy::LILY_OVERFLOW_DELAY and
+                           co_await this->admission->asyncAcquire()};
+
+            auto socket {co_await this->acceptor.async_accept(
+                strand, boost::asio::redirect_error(boost::asio::use_awaitable, ec))};
+            if (ec)
+            {
+                if (admitted)
+                    this->admission->release();
+                if (!co_await retryAccept(this->acceptor, ec, "server context"))
+                    co_return;
+                continue;
+            }
+
+            boost::asio::co_spawn(
+                strand,
+                [session {std::make_shared<AsyncServerSession>(std::move(socket), this->ctx, nullptr,
+                                                               this->admission.get(), admitted,
+                                                               this->options.streamWindow)}]
+                { return session->run(); },
+                boost::asio::detached);
         }
     }
 } // namespace lily::net
@@ -0,0 +1,183 @@
+#include <boost/asio/error.hpp>
+#include <boost/asio/ssl/error.hpp>
+#include <fmt/core.h>
+#include <iterator>
+#include <utility>
+
+#include <lily/net/ServerMetrics.h>
+
+namespace lily::net
+{
+    // The upper bounds (in µs) of the histogram buckets exposed to Prometheus, before the implicit `+Inf` one
+    static constexpr std::array<uint64_t, 16> BUCKET_BOUNDS {
+        100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000,
+        10000000};
+
+    // Append one counter or gauge with its help and type lines
+    static void formatCounter(std::string& text, std::string_view name, std::string_view type, std::string_view help,
+                              uint64_t value)
+    {
+        fmt::format_to(std::back_inserter(text), "# HELP {0} {1}\n# TYPE {0} {2}\n{0} {3}\n", name, help, type,
+                       value);
+    }
+
+    // Append one histogram, converted from µs to seconds
+    static void formatHistogram(std::string& text, std::string_view name, std::string_view help,
+                                log::LatencyHistogram const& histogram)
+    {
+        fmt::format_to(std::back_inserter(text), "# HELP {0} {1}\n# TYPE {0} histogram\n", name, help);
+        for (auto bound: BUCKET_BOUNDS)
+            fmt::format_to(std::back_inserter(text), "{}_bucket{{le=\"{}\"}} {}\n", name, bound / 1e6,
+                           histogram.getCountAtOrBelow(bound));
+
+        // The count is summed from the buckets, so it matches the `+Inf` bucket even while recording
+        auto count {histogram.getCountAtOrBelow(UINT64_MAX)};
+        fmt::format_to(std::back_inserter(text), "{0}_bucket{{le=\"+Inf\"}} {1}\n{0}_sum {2}\n{0}_count {1}\n", name,
+                       count, histogram.getSum() / 1e6);
+    }
+
+    ServerMetrics& ServerMetrics::getInstance()
+    {
+        static ServerMetrics instance {};
+        return instance;
+    }
+
+    void ServerMetrics::enable()
+    {
+        this->shards = std::make_unique<std::array<Shard, SHARD_COUNT>>();
+    }
+
+    ServerMetrics::Shard& ServerMetrics::getShard()
+    {
+        // The threads take the shards in turn, so the workers of a pool never share one below `SHARD_COUNT`
+        static std::atomic_uint32_t nextShard {};
+        thread_local auto index {nextShard.fetch_add(1, std::memory_order_relaxed) % SHARD_COUNT};
+        return (*this->shards)[index];
+    }
+
+    uint64_t ServerMetrics::getTotal(Counter counter) const
+    {
+        uint64_t total {};
+        for (auto const& shard: *this->shards)
+            total += shard.counters[counter].load(std::memory_order_relaxed);
+        return total;
+    }
+
+    void ServerMetrics::recordAccepted()
+    {
+        if (this->isEnabled())
+            this->getShard().counters[LILY_METRIC_ACCEPTED].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void ServerMetrics::recordShed()
+    {
+        if (this->isEnabled())
+            this->getShard().counters[LILY_METRIC_SHED].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void ServerMetrics::recordHandshakeStarted()
+    {
+        if (this->isEnabled())
+            this->getShard().counters[LILY_METRIC_HANDSHAKES_STARTED].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void ServerMetrics::recordHandshake(int64_t durationUs, boost::system::error_code const& ec)
+    {
+        if (!this->isEnabled())
+            return;
+
+        auto& shard {this->getShard()};
+        if (!ec)
+        {
+            shard.counters[LILY_METRIC_HANDSHAKES_OK].fetch_add(1, std::memory_order_relaxed);
+            return shard.handshake.record(durationUs);
+        }
+
+        // Classify the failure
+        auto counter {LILY_METRIC_HANDSHAKES_OTHER};
+        if (ec == boost::asio::ssl::error::stream_truncated or ec == boost::asio::error::eof)
+            counter = LILY_METRIC_HANDSHAKES_TRUNCATED;
+        else if (ec == boost::asio::error::connection_reset or ec == boost::asio::error::broken_pipe)
+            counter = LILY_METRIC_HANDSHAKES_RESET;
+        else if (ec == boost::asio::error::timed_out)
+            counter = LILY_METRIC_HANDSHAKES_TIMEOUT;
+        else if (ec.category() == boost::asio::error::get_ssl_category())
+            counter = LILY_METRIC_HANDSHAKES_TLS;
+        shard.counters[counter].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void ServerMetrics::recordRequest(uint64_t readSize, int64_t readUs, uint64_t writeSize, int64_t writeUs)
+    {
+        if (!this->isEnabled())
+            return;
+
+        auto& shard {this->getShard()};
+        shard.counters[LILY_METRIC_REQUESTS].fetch_add(1, std::memory_order_relaxed);
+        shard.counters[LILY_METRIC_BYTES_RECEIVED].fetch_add(readSize, std::memory_order_relaxed);
+        shard.counters[LILY_METRIC_BYTES_SENT].fetch_add(writeSize, std::memory_order_relaxed);
+        shard.read.record(readUs);
+        shard.write.record(writeUs);
+    }
+
+    std::string ServerMetrics::format() const
+    {
+        if (!this->isEnabled())
+            return {};
+
+        // Merge the histograms of every shard
+        auto handshake {std::make_unique<log::LatencyHistogram>()};
+        auto read {std::make_unique<log::LatencyHistogram>()};
+        auto write {std::make_unique<log::LatencyHistogram>()};
+        for (auto const& shard: *this->shards)
+        {
+            handshake->add(shard.handshake);
+            read->add(shard.read);
+            write->add(shard.write);
+        }
+
+        std::string text {};
+        formatCounter(text, "lily_server_accepted_connections_total", "counter",
+                      "The connections accepted by the server.", this->getTotal(LILY_METRIC_ACCEPTED));
+        formatCounter(text, "lily_server_shed_connections_total", "counter",
+                      "The connections shed with a TCP reset by the handshake admission.",
+                      this->getTotal(LILY_METRIC_SHED));
+
+        // The failed handshakes share one metric, labelled by error class
+        fmt::format_to(std::back_inserter(text),
+                       "# HELP lily_server_handshakes_total The finished handshakes, by result.\n"
+                       "# TYPE lily_server_handshakes_total counter\n");
+        constexpr std::array<std::pair<Counter, std::string_view>, 6> results {
+            {{LILY_METRIC_HANDSHAKES_OK, "ok"},
+             {LILY_METRIC_HANDSHAKES_TRUNCATED, "truncated"},
+             {LILY_METRIC_HANDSHAKES_RESET, "reset"},
+             {LILY_METRIC_HANDSHAKES_TIMEOUT, "timeout"},
+             {LILY_METRIC_HANDSHAKES_TLS, "tls"},
+             {LILY_METRIC_HANDSHAKES_OTHER, "other"}}};
+        uint64_t finished {};
+        for (auto [counter, result]: results)
+        {
+            auto total {this->getTotal(counter)};
+            finished += total;
+            fmt::format_to(std::back_inserter(text), "lily_server_handshakes_total{{result=\"{}\"}} {}\n", result,
+                           total);
+        }
+
+        // The relaxed loads of different shards may briefly see a handshake finish before its start
+        auto started {this->getTotal(LILY_METRIC_HANDSHAKES_STARTED)};
+        formatCounter(text, "lily_server_handshakes_in_flight", "gauge", "The handshakes running right now.",
+                      started > finished ? started - finished : 0);
+
+        formatCounter(text, "lily_server_requests_total", "counter", "The echoed requests.",
+                      this->getTotal(LILY_METRIC_REQUESTS));
+        formatCounter(text, "lily_server_received_bytes_total", "counter", "The HTTP bytes of the echoed requests.",
+                      this->getTotal(LILY_METRIC_BYTES_RECEIVED));
+        formatCounter(text, "lily_server_sent_bytes_total", "counter", "The HTTP bytes of the echo responses.",
+                      this->getTotal(LILY_METRIC_BYTES_SENT));
+
+        formatHistogram(text, "lily_server_handshake_duration_seconds", "The duration of the successful handshakes.",
+                        *handshake);
+        formatHistogram(text, "lily_server_read_duration_seconds", "The duration of the request reads.", *read);
+        formatHistogram(text, "lily_server_write_duration_seconds", "The duration of the response writes.", *write);
+        return text;
+    }
+} // namespace lily::net
@@ -6,6 +6,8 @@
 
 #include <lily/core/ErrorCode.h>
 #include <lily/log/ServerLog.h>
+#include <lily/net/ConnectionTrace.h>
+#include <lily/net/ServerMetrics.h>
 #include <lily/net/ServerSession.h>
 
 using namespace lily::core;
@@ -13,21 +15,70 @@ using namespace lily::log;
 
 namespace lily::net
 {
+    // The TCP socket under the TLS stream
+    static boost::asio::ip::tcp::socket& getSocket(boost::asio::ssl::stream<boost::beast::tcp_stream>& stream)
+    {
+        return stream.next_layer().socket();
+    }
+    static boost::asio::ip::tcp::socket& getSocket(KtlsStream& stream)
+    {
+        return stream.next_layer();
+    }
+
+    ServerSession::SessionStream ServerSession::makeStream(boost::asio::ip::tcp::socket&& socket,
+                                                           boost::asio::ssl::context& ctx, SSL* ssl, bool ktls)
+    {
+        if (!ktls)
+            return SessionPool::makeStream(std::move(socket), ctx, ssl);
+
+        // Like the Asio stream, the kTLS stream takes ownership of one reference of the pooled object
+        return SessionStream {std::in_place_type<KtlsStream>, std::move(socket),
+                              ssl ? ssl : SSL_new(ctx.native_handle())};
+    }
+
     void ServerSession::run()
+    {
+        std::visit([this](auto& stream) { this->serve(stream); }, this->stream);
+    }
+
+    template<class Stream>
+    void ServerSession::serve(Stream& stream)
     {
         // Variable that collect the error code thrown by boost function
         boost::beast::error_code ec {};
 
-        // Set the timeout.
-        boost::beast::get_lowest_layer(this->stream).expires_never();
+        auto& metrics {ServerMetrics::getInstance()};
+        metrics.recordAccepted();
+
+        // Wait for a handshake slot, or shed the connection with a TCP reset
+        if (this->admission and !this->admitted and !this->admission->acquire())
+        {
+            metrics.recordShed();
+            return HandshakeAdmission::reset(getSocket(stream));
+        }
 
         // Perform the SSL handshake and measure the handshake time using `std::chrono`. This will measure the whole
-        // handshake process duration.
+        // handshake process duration, and the trace splits it between the handshake messages.
+        metrics.recordHandshakeStarted();
         auto beginHandshakeTime {std::chrono::high_resolution_clock::now()};
-        this->stream.handshake(boost::asio::ssl::stream_base::server, ec);
+        log::HandshakePhases phases {};
+        log::HandshakeTraffic traffic {};
+        log::NegotiatedParameters parameters {};
+        log::ConnectionContext context {};
+        {
+            ConnectionTrace trace {stream.native_handle()};
+            stream.handshake(boost::asio::ssl::stream_base::server, ec);
+            phases     = trace.getPhases();
+            traffic    = trace.getTraffic();
+            parameters = trace.getParameters();
+            context    = trace.getContext();
+        }
         auto handshakeDuration {std::chrono::duration_cast<std::chrono::microseconds>(
                                     std::chrono::high_resolution_clock::now() - beginHandshakeTime)
                                     .count()};
+        if (this->admission)
+            this->admission->release();
+        metrics.recordHandshake(handshakeDuration, ec);
         if (ec)
         {
             if (ec != boost::beast::net::ssl::error::stream_truncated and ec != boost::asio::error::broken_pipe and
@@ -38,11 +89,25 @@ namespace lily::net
 
         while (true)
         {
+            // Forward the body chunks as they are decrypted, so the memory stays bounded by the window
+            if (!this->window.empty())
+            {
+                auto keep_alive {
+                    this->echoStreaming(stream, handshakeDuration, phases, traffic, parameters, context, ec)};
+                if (ec == boost::beast::http::error::end_of_stream)
+                    break;
+                if (ec)
+                    return;
+                if (!keep_alive)
+                    break;
+                continue;
+            }
+
             boost::beast::http::request<boost::beast::http::string_body> req {};
 
             // Perform the SSL read and measure the duration
             auto beginReadTime {std::chrono::high_resolution_clock::now()};
-            auto readSize {boost::beast::http::read(this->stream, this->buffer, req, ec)};
+            auto readSize {boost::beast::http::read(stream, this->buffer, req, ec)};
             auto readDuration {std::chrono::duration_cast<std::chrono::microseconds>(
                                    std::chrono::high_resolution_clock::now() - beginReadTime)
                                    .count()};
@@ -52,30 +117,14 @@ namespace lily::net
                 return;
 
             // Handle request
-            boost::beast::http::message_generator msg {
-                [](boost::beast::http::request<boost::beast::http::string_body>&& req)
-                    -> boost::beast::http::message_generator
-                {
-                    // Create empty HTTP response
-                    boost::beast::http::response<boost::beast::http::string_body> res {
-                        boost::beast::http::status::bad_request, req.version()};
-                    res.set(boost::beast::http::field::server, BOOST_BEAST_VERSION_STRING);
-                    res.set(boost::beast::http::field::content_type, "text/plain");
-                    res.set(boost::beast::http::field::connection, req.keep_alive() ? "keep-alive" : "close");
-                    res.keep_alive(req.keep_alive());
-
-                    // Echo the body sent by the client
-                    res.body().assign(std::move(req.body()));
-                    res.prepare_payload();
-                    return res;
-                }(std::move(req))};
+            boost::beast::http::message_generator msg {makeEchoResponse(std::move(req))};
 
             // Determine if we should close the connection
             bool keep_alive {msg.keep_alive()};
 
             // Send the response
             auto beginWriteTime {std::chrono::high_resolution_clock::now()};
-            auto writeSize {boost::beast::write(this->stream, std::move(msg), ec)};
+            auto writeSize {boost::beast::write(stream, std::move(msg), ec)};
             auto writeDuration {std::chrono::duration_cast<std::chrono::microseconds>(
                                     std::chrono::high_resolution_clock::now() - beginWriteTime)
                                     .count()};
@@ -88,7 +137,11 @@ namespace lily::net
             }
 
             // Log server SSL performance
-            ServerLog::getInstance().write(handshakeDuration, readSize, readDuration, writeSize, writeDuration);
+            metrics.recordRequest(readSize, readDuration, writeSize, writeDuration);
+            auto [ktlsSend, ktlsRecv] {KtlsStream::getOffload(stream)};
+            ServerLog::getInstance().write(handshakeDuration, phases, traffic, readSize, readDuration, writeSize,
+                                           writeDuration, SSL_session_reused(stream.native_handle()) == 1, ktlsSend,
+                                           ktlsRecv, parameters, context.id, context.primitives);
 
             if (!keep_alive)
             {
@@ -99,16 +152,126 @@ namespace lily::net
         }
 
         // Perform the SSL shutdown
-        return this->close();
+        return this->close(stream);
+    }
+
+    boost::beast::http::response<boost::beast::http::string_body>
+        ServerSession::makeEchoResponse(boost::beast::http::request<boost::beast::http::string_body>&& req)
+    {
+        // Create empty HTTP response
+        boost::beast::http::response<boost::beast::http::string_body> res {boost::beast::http::status::bad_request,
+                                                                           req.version()};
+        res.set(boost::beast::http::field::server, BOOST_BEAST_VERSION_STRING);
+        res.set(boost::beast::http::field::content_type, "text/plain");
+        res.set(boost::beast::http::field::connection, req.keep_alive() ? "keep-alive" : "close");
+        res.keep_alive(req.keep_alive());
+
+        // Echo the body sent by the client
+        res.body().assign(std::move(req.body()));
+        res.prepare_payload();
+        return res;
+    }
+
+    template<class Stream>
+    bool ServerSession::echoStreaming(Stream& stream, int64_t handshakeDuration, log::HandshakePhases const& phases,
+                                      log::HandshakeTraffic const& traffic,
+                                      log::NegotiatedParameters const& parameters,
+                                      log::ConnectionContext const& context, boost::beast::error_code& ec)
+    {
+        // The request body is parsed into the window instead of a growing string, so its size isn't limited
+        boost::beast::http::request_parser<boost::beast::http::buffer_body> parser {};
+        parser.body_limit(std::numeric_limits<uint64_t>::max());
+
+        // Perform the SSL read of the request header
+        auto beginReadTime {std::chrono::high_resolution_clock::now()};
+        auto readSize {boost::beast::http::read_header(stream, this->buffer, parser, ec)};
+        auto readDuration {std::chrono::high_resolution_clock::now() - beginReadTime};
+        if (ec)
+            return false;
+
+        // Send the response header, the response body is written chunk by chunk below
+        auto res {makeStreamingEchoResponse(parser)};
+        boost::beast::http::response_serializer<boost::beast::http::buffer_body> serializer {res};
+        auto beginWriteTime {std::chrono::high_resolution_clock::now()};
+        auto writeSize {boost::beast::http::write_header(stream, serializer, ec)};
+        auto writeDuration {std::chrono::high_resolution_clock::now() - beginWriteTime};
+
+        while (!ec and !serializer.is_done())
+        {
+            // Decrypt the next request body chunk into the window
+            auto& reqBody {parser.get().body()};
+            reqBody.data = this->window.data();
+            reqBody.size = this->window.size();
+            if (!parser.is_done())
+            {
+                beginReadTime = std::chrono::high_resolution_clock::now();
+                readSize += boost::beast::http::read(stream, this->buffer, parser, ec);
+                readDuration += std::chrono::high_resolution_clock::now() - beginReadTime;
+                if (ec == boost::beast::http::error::need_buffer)
+                    ec = {};
+                if (ec)
+                    return false;
+            }
+
+            // Forward the chunk to the response
+            auto& resBody {res.body()};
+            resBody.data = this->window.data();
+            resBody.size = this->window.size() - reqBody.size;
+            resBody.more = !parser.is_done();
+            beginWriteTime = std::chrono::high_resolution_clock::now();
+            writeSize += boost::beast::http::write(stream, serializer, ec);
+            writeDuration += std::chrono::high_resolution_clock::now() - beginWriteTime;
+            if (ec == boost::beast::http::error::need_buffer)
+                ec = {};
+        }
+        if (ec)
+        {
+            if (ec != boost::beast::net::ssl::error::stream_truncated and ec != boost::asio::error::broken_pipe and
+                ec != boost::asio::error::connection_reset)
+                spdlog::error("Lily-PQC server SSL write to client failed! Why: {}", ec.message());
+            return false;
+        }
+
+        // Log server SSL performance
+        auto readUs {std::chrono::duration_cast<std::chrono::microseconds>(readDuration).count()};
+        auto writeUs {std::chrono::duration_cast<std::chrono::microseconds>(writeDuration).count()};
+        ServerMetrics::getInstance().recordRequest(readSize, readUs, writeSize, writeUs);
+        auto [ktlsSend, ktlsRecv] {KtlsStream::getOffload(stream)};
+        ServerLog::getInstance().write(handshakeDuration, phases, traffic, readSize, readUs, writeSize, writeUs,
+                                       SSL_session_reused(stream.native_handle()) == 1, ktlsSend, ktlsRecv,
+                                       parameters, context.id, context.primitives);
+        return res.keep_alive();
+    }
+
+    boost::beast::http::response<boost::beast::http::buffer_body> ServerSession::makeStreamingEchoResponse(
+        boost::beast::http::request_parser<boost::beast::http::buffer_body> const& parser)
+    {
+        auto const& req {parser.get()};
+
+        // Create empty HTTP response
+        boost::beast::http::response<boost::beast::http::buffer_body> res {boost::beast::http::status::bad_request,
+                                                                           req.version()};
+        res.set(boost::beast::http::field::server, BOOST_BEAST_VERSION_STRING);
+        res.set(boost::beast::http::field::content_type, "text/plain");
+        res.set(boost::beast::http::field::connection, req.keep_alive() ? "keep-alive" : "close");
+        res.keep_alive(req.keep_alive());
+
+        // The echoed body has the same length as the request body, if it is known upfront
+        if (auto contentLength {parser.content_length()})
+            res.content_length(contentLength.value());
+        else
+            res.chunked(true);
+        return res;
     }
 
-    void ServerSession::close()
+    template<class Stream>
+    void ServerSession::close(Stream& stream)
     {
         // Variable that collect the error code thrown by boost function
         boost::beast::error_code ec {};
 
         // Perform the SSL shutdown
-        this->stream.shutdown(ec);
+        stream.shutdown(ec);
         if (ec)
         {
             if (ec != boost::beast::net::ssl::error::stream_truncated and ec != boost::asio::error::broken_pipe and
@@ -0,0 +1,66 @@
+#include <cstring>
+#include <pthread.h>
+#include <spdlog/spdlog.h>
+#include <thread>
+
+#include <lily/net/AcceptRetry.h>
+#include <lily/net/AsyncServerSession.h>
+#include <lily/net/ServerShard.h>
+
+namespace lily::net
+{
+    ServerShard::ServerShard(uint32_t index, ServerOptions const& options):
+        index {index}, options {options}, ioc {std::make_unique<boost::beast::net::io_context>(1)},
+        ctx {boost::asio::ssl::context::tlsv13_server}, acceptor {*ioc.get()},
+        admission {HandshakeAdmission::create(options)}
+    {
+    }
+
+    void ServerShard::run()
+    {
+        // Pin the shard thread to its core. The server keeps running unpinned if the affinity can't be applied.
+        cpu_set_t cpuSet {};
+        CPU_ZERO(&cpuSet);
+        CPU_SET(this->index % std::max(std::thread::hardware_concurrency(), 1u), &cpuSet);
+        if (auto err {pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet)}; err != 0)
+            spdlog::warn("Lily-PQC server shard {} failed to pin its thread! Why: {}", this->index,
+                         std::strerror(err));
+
+        boost::asio::co_spawn(*this->ioc, this->acceptAsync(), boost::asio::detached);
+        this->ioc->run();
+    }
+
+    boost::asio::awaitable<void> ServerShard::acceptAsync()
+    {
+        // Variable that collect the error code thrown by boost function
+        boost::beast::error_code ec {};
+
+        while (true)
+        {
+            // With the delay policy, the slot is acquired before accepting, so the connections wait in the backlog
+            bool admitted {this->admission and this->admission->getPolicy() == OverflowPolicy::LILY_OVERFLOW_DELAY and
+                           co_await this->admission->asyncAcquire()};
+
+            // The shard is single threaded, so the accepted sockets share its `io_context` executor
+            auto socket {
+                co_await this->acceptor.async_accept(boost::asio::redirect_error(boost::asio::use_awaitable, ec))};
+            if (ec)
+            {
+                if (admitted)
+                    this->admission->release();
+                if (!co_await retryAccept(this->acceptor, ec, fmt::format("server shard {}", this->index)))
+                    co_return;
+                continue;
+            }
+            this->acceptedCount.fetch_add(1, std::memory_order_relaxed);
+
+            boost::asio::co_spawn(
+                *this->ioc,
+                [session {std::make_shared<AsyncServerSession>(std::move(socket), this->ctx, &this->handshakeCount,
+                                                               this->admission.get(), admitted,
+                                                               this->options.streamWindow)}]
+                { return session->run(); },
+                boost::asio::detached);
+        }
+    }
+} // namespace lily::net
@@ -0,0 +1,139 @@
+#include <lily/net/SessionPool.h>
+
+namespace lily::net
+{
+    // The objects kept by the current worker
+    struct WorkerPool
+    {
+        std::vector<SSL*> ssls {};
+        std::vector<boost::beast::flat_buffer> buffers {};
+
+        ~WorkerPool()
+        {
+            SessionPool::getInstance().adopt(this->ssls, this->buffers);
+        }
+    };
+    static thread_local WorkerPool workerPool {};
+
+    SessionPool& SessionPool::getInstance()
+    {
+        static SessionPool instance {};
+        return instance;
+    }
+
+    void SessionPool::adopt(std::vector<SSL*>& ssls, std::vector<boost::beast::flat_buffer>& buffers)
+    {
+        std::lock_guard lock {this->mutex};
+        for (auto ssl: ssls)
+        {
+            if (this->sharedSSLs.size() < this->capacity)
+                this->sharedSSLs.push_back(ssl);
+            else
+                SSL_free(ssl);
+        }
+        for (auto& buffer: buffers)
+        {
+            if (this->sharedBuffers.size() >= this->capacity)
+                break;
+            this->sharedBuffers.emplace_back(std::move(buffer));
+        }
+        ssls.clear();
+        buffers.clear();
+    }
+
+    SSL* SessionPool::acquireSSL(SSL_CTX* ctx)
+    {
+        if (!this->isEnabled())
+            return nullptr;
+        this->acquiredCount.fetch_add(1, std::memory_order_relaxed);
+
+        // Take the newest object of this worker, or of the exited workers
+        SSL* ssl {};
+        if (!workerPool.ssls.empty())
+        {
+            ssl = workerPool.ssls.back();
+            workerPool.ssls.pop_back();
+        }
+        else
+        {
+            std::lock_guard lock {this->mutex};
+            if (!this->sharedSSLs.empty())
+            {
+                ssl = this->sharedSSLs.back();
+                this->sharedSSLs.pop_back();
+            }
+        }
+
+        // An object can only be reused with the context it was created from
+        if (ssl and SSL_get_SSL_CTX(ssl) != ctx)
+        {
+            SSL_free(ssl);
+            ssl = nullptr;
+        }
+        if (ssl)
+            this->sslHitCount.fetch_add(1, std::memory_order_relaxed);
+        else if (ssl = SSL_new(ctx); !ssl)
+            return nullptr;
+
+        // The stream releases its own reference, the pool keeps the other one
+        SSL_up_ref(ssl);
+        return ssl;
+    }
+
+    void SessionPool::releaseSSL(SSL* ssl)
+    {
+        // Reset the object for the next connection, drop it if it can't be reset or the pool is full
+        if (workerPool.ssls.size() >= this->capacity or SSL_clear(ssl) <= 0)
+            return SSL_free(ssl);
+        workerPool.ssls.push_back(ssl);
+    }
+
+    boost::beast::flat_buffer SessionPool::acquireBuffer()
+    {
+        if (!this->isEnabled())
+            return boost::beast::flat_buffer {};
+
+        boost::beast::flat_buffer buffer {};
+        if (!workerPool.buffers.empty())
+        {
+            buffer = std::move(workerPool.buffers.back());
+            workerPool.buffers.pop_back();
+        }
+        else
+        {
+            std::lock_guard lock {this->mutex};
+            if (this->sharedBuffers.empty())
+                return buffer;
+            buffer = std::move(this->sharedBuffers.back());
+            this->sharedBuffers.pop_back();
+        }
+        this->bufferHitCount.fetch_add(1, std::memory_order_relaxed);
+        return buffer;
+    }
+
+    void SessionPool::releaseBuffer(boost::beast::flat_buffer&& buffer)
+    {
+        // Nothing to keep from a buffer that never grew, or was moved from
+        if (!this->isEnabled() or buffer.capacity() == 0 or workerPool.buffers.size() >= this->capacity)
+            return;
+
+        // Only the content is dropped, the allocated capacity is kept
+        buffer.clear();
+        workerPool.buffers.emplace_back(std::move(buffer));
+    }
+
+    boost::asio::ssl::stream<boost::beast::tcp_stream>
+    SessionPool::makeStream(boost::asio::ip::tcp::socket&& socket, boost::asio::ssl::context& ctx, SSL* ssl)
+    {
+        // The stream takes ownership of one reference of the pooled object
+        using Stream = boost::asio::ssl::stream<boost::beast::tcp_stream>;
+        if (!ssl)
+            return Stream(boost::beast::tcp_stream {std::move(socket)}, ctx);
+
+        // Keep the record buffers between the connections instead of releasing them when idle. Cleared once the
+        // stream is built, as its engine sets the mode again on the object it takes.
+        Stream stream(boost::beast::tcp_stream {std::move(socket)}, ssl);
+        SSL_clear_mode(stream.native_handle(), SSL_MODE_RELEASE_BUFFERS);
+        return stream;
+    }
+} // namespace lily::net
@@ -0,0 +1,127 @@
+#include <fmt/chrono.h>
+#include <fmt/color.h>
+#include <fmt/core.h>
+#include <fstream>
+#include <spdlog/spdlog.h>
+
+#include <lily/core/Constants.h>
+#include <lily/net/Sweep.h>
+
+using namespace lily::core;
+
+namespace lily::net
+{
+    Sweep::Sweep(ClientOptions const& clientOptions, SweepOptions const& options):
+        clientOptions(clientOptions), options(options)
+    {
+    }
+
+    std::vector<std::string> Sweep::expand(std::vector<std::string> const& names, std::string_view supported)
+    {
+        std::vector<std::string> expanded {};
+        for (auto const& name: names)
+        {
+            if (name != "all")
+            {
+                expanded.push_back(name);
+                continue;
+            }
+            for (std::size_t begin {}; begin < supported.size();)
+            {
+                auto end {std::min(supported.find(':', begin), supported.size())};
+                expanded.emplace_back(supported.substr(begin, end - begin));
+                begin = end + 1;
+            }
+        }
+        return expanded;
+    }
+
+    void Sweep::run()
+    {
+        // Build every cell, an empty list of signature algorithms offers them all at once
+        auto tlsGroups {expand(this->options.tlsGroups, constants::SUPPORTED_PQC_GROUPS_LIST)};
+        auto sigalgs {expand(this->options.sigalgs, constants::SUPPORTED_SIGALGS_LIST)};
+        if (sigalgs.empty())
+            sigalgs.emplace_back();
+
+        std::vector<Cell> cells {};
+        for (auto const& tlsGroup: tlsGroups)
+            for (auto const& sigalg: sigalgs)
+                for (auto dataLength: this->options.dataLengths)
+                    for (auto concurrentUsers: this->options.concurrentUsers)
+                    {
+                        auto& cell {cells.emplace_back(Cell {this->clientOptions})};
+                        cell.options.tlsGroup        = tlsGroup;
+                        cell.options.sigalgs         = sigalg;
+                        cell.options.dummyDataLength = dataLength;
+                        cell.options.concurrentUsers = concurrentUsers;
+                        cell.options.rate            = 0;
+                    }
+
+        // Measure the cells in turn against the same server
+        for (std::size_t i {}; i < cells.size(); ++i)
+        {
+            auto& cell {cells[i]};
+            fmt::print("[-] Cell {}/{} | Group: {} | Sigalgs: {} | Data Length: {} B | Users: {}\r\n", i + 1,
+                       cells.size(), cell.options.tlsGroup, cell.options.sigalgs.empty() ? "all" : cell.options.sigalgs,
+                       cell.options.dummyDataLength, cell.options.concurrentUsers);
+
+            // A group or an algorithm unknown to the providers only fails its own cell
+            auto outcomeRunner {ClientRunner::create(cell.options)};
+            if (!outcomeRunner)
+            {
+                cell.measurement.errorRate = 1.0;
+                continue;
+            }
+            auto& runner {*outcomeRunner.assume_value()};
+            cell.measurement = runner.measure(0, std::chrono::seconds {this->options.warmUpSeconds},
+                                              std::chrono::seconds {this->options.windowSeconds});
+            cell.measured = true;
+
+            auto const& measurement {cell.measurement};
+            fmt::print("[-] TPS : {:.2f} req/s | Handshake p50: {:.2f} ms | Handshake p99: {:.2f} ms | Handshake "
+                       "bytes: {:.0f}/{:.0f} B | Error: {:.2f}%\r\n",
+                       measurement.tps, measurement.p50HandshakeUs / 1000.0, measurement.p99HandshakeUs / 1000.0,
+                       measurement.handshakeBytesSent, measurement.handshakeBytesReceived, measurement.errorRate * 100);
+        }
+
+        writeTables(cells);
+    }
+
+    void Sweep::writeTables(std::vector<Cell> const& cells)
+    {
+        auto fileName {fmt::format("{:%F_%T}_sweep_client", fmt::localtime(std::time(nullptr)))};
+        std::ofstream csvStream {fileName + ".csv"};
+        std::ofstream jsonStream {fileName + ".json"};
+        if (!csvStream.is_open() or !jsonStream.is_open())
+        {
+            spdlog::error("Failed to create client sweep table");
+            return;
+        }
+
+        csvStream << "tls_group;sigalgs;data_length;concurrent_users;measured;tps;error_rate;p50_handshake_us;"
+                     "p99_handshake_us;p50_latency_us;p99_latency_us;hs_bytes_sent;hs_bytes_received\r\n";
+        jsonStream << "[\n";
+        for (std::size_t i {}; i < cells.size(); ++i)
+        {
+            auto const& [options, measurement, measured] {cells[i]};
+            csvStream << fmt::format("{};{};{};{};{:d};{:.2f};{:.4f};{};{};{};{};{:.0f};{:.0f}\r\n", options.tlsGroup,
+                                     options.sigalgs, options.dummyDataLength, options.concurrentUsers, measured,
+                                     measurement.tps, measurement.errorRate, measurement.p50HandshakeUs,
+                                     measurement.p99HandshakeUs, measurement.p50LatencyUs, measurement.p99LatencyUs,
+                                     measurement.handshakeBytesSent, measurement.handshakeBytesReceived);
+            jsonStream << fmt::format(
+                R"(  {{"tls_group": "{}", "sigalgs": "{}", "data_length": {}, "concurrent_users": {}, "measured": {}, )"
+                R"("tps": {:.2f}, "error_rate": {:.4f}, "handshake_us": {{"p50": {}, "p99": {}}}, )"
+                R"("latency_us": {{"p50": {}, "p99": {}}}, "hs_bytes": {{"sent": {:.0f}, "received": {:.0f}}}}}{})"
+                "\n",
+                options.tlsGroup, options.sigalgs, options.dummyDataLength, options.concurrentUsers, measured,
+                measurement.tps, measurement.errorRate, measurement.p50HandshakeUs, measurement.p99HandshakeUs,
+                measurement.p50LatencyUs, measurement.p99LatencyUs, measurement.handshakeBytesSent,
+                measurement.handshakeBytesReceived, i + 1 < cells.size() ? "," : "");
+        }
+        jsonStream << "]\n";
+        fmt::print(fmt::fg(fmt::color::green), "[v] Sweep of {} cells saved to `{}.csv` and `{}.json`\r\n",
+                   cells.size(), fileName, fileName);
+    }
+} // namespace lily::net